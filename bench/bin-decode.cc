@@ -0,0 +1,147 @@
+#include <iostream>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "wasm.hh"
+#include "wasm-bin.hh"
+
+// Decoding benchmark for module metadata. Builds a synthetic module with
+// many imports, functions and exports, then times the metadata decoder and
+// the batch LEB128 decoder against a plain scalar loop.
+
+const uint32_t N_TYPES = 300;  // type indices >= 128 take two bytes
+const uint32_t N_IMPORTS = 20000;
+const uint32_t N_FUNCS = 200000;
+const int N_REPS = 50;
+
+
+void put_u32(std::string& out, uint32_t n) {
+  char buf[5];
+  auto ptr = buf;
+  wasm::bin::encode_u32(ptr, n);
+  out.append(buf, ptr - buf);
+}
+
+void put_name(std::string& out, const std::string& name) {
+  put_u32(out, name.size());
+  out += name;
+}
+
+void put_section(std::string& out, char id, const std::string& payload) {
+  out += id;
+  put_u32(out, payload.size());
+  out += payload;
+}
+
+
+// Function type i takes i % 4 i32 parameters and returns one i64.
+auto make_binary(std::string& funcs) -> wasm::vec<byte_t> {
+  std::string types, imports, exports;
+  put_u32(types, N_TYPES);
+  for (uint32_t i = 0; i < N_TYPES; ++i) {
+    types += '\x60';
+    put_u32(types, i % 4);
+    types.append(i % 4, '\x7f');
+    put_u32(types, 1);
+    types += '\x7e';
+  }
+  put_u32(imports, N_IMPORTS);
+  for (uint32_t i = 0; i < N_IMPORTS; ++i) {
+    put_name(imports, "env");
+    put_name(imports, "import" + std::to_string(i));
+    imports += '\x00';
+    put_u32(imports, i % N_TYPES);
+  }
+  put_u32(funcs, N_FUNCS);
+  for (uint32_t i = 0; i < N_FUNCS; ++i) {
+    // Mostly small indices, with a sprinkling of two-byte ones.
+    put_u32(funcs, i % 16 == 0 ? i % N_TYPES : i % 100);
+  }
+  put_u32(exports, N_FUNCS);
+  for (uint32_t i = 0; i < N_FUNCS; ++i) {
+    put_name(exports, "export" + std::to_string(i));
+    exports += '\x00';
+    put_u32(exports, N_IMPORTS + i);
+  }
+
+  std::string binary("\0asm\1\0\0\0", 8);
+  put_section(binary, 1, types);
+  put_section(binary, 2, imports);
+  put_section(binary, 3, funcs);
+  put_section(binary, 7, exports);
+  auto result = wasm::vec<byte_t>::make_uninitialized(binary.size());
+  std::memcpy(result.get(), binary.data(), binary.size());
+  return result;
+}
+
+
+template<class F>
+auto measure(const char* what, size_t per_rep, F f) -> double {
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < N_REPS; ++i) f();
+  auto end = std::chrono::steady_clock::now();
+  auto ns = std::chrono::duration<double, std::nano>(end - start).count();
+  auto per_item = ns / N_REPS / per_rep;
+  std::cout << "  " << what << ": " << ns / N_REPS / 1e6 << " ms, "
+    << per_item << " ns/item" << std::endl;
+  return per_item;
+}
+
+
+// Times scalar against batch decoding of a run of N_FUNCS numbers.
+auto compare(const byte_t* run, const byte_t* end) -> bool {
+  std::vector<uint32_t> scalar(N_FUNCS), batch(N_FUNCS);
+  auto t_scalar = measure("scalar", N_FUNCS, [&] {
+    auto pos = run;
+    for (uint32_t i = 0; i < N_FUNCS; ++i) scalar[i] = wasm::bin::u32(pos);
+  });
+  auto t_batch = measure("batch", N_FUNCS, [&] {
+    auto pos = run;
+    wasm::bin::u32s(pos, end, batch.data(), N_FUNCS);
+  });
+  if (scalar != batch) {
+    std::cout << "> Error: batch decoding mismatch!" << std::endl;
+    return false;
+  }
+  std::cout << "> Speed-up " << t_scalar / t_batch << "x" << std::endl;
+  return true;
+}
+
+
+auto main(int argc, const char* argv[]) -> int {
+  std::cout << "Building synthetic module..." << std::endl;
+  std::string funcs;
+  auto binary = make_binary(funcs);
+  std::cout << "> " << binary.size() << " bytes, " << N_IMPORTS
+    << " imports, " << N_FUNCS << " functions" << std::endl;
+
+  // Skip the count, leaving the LEB128 run of type indices.
+  auto begin = reinterpret_cast<const byte_t*>(funcs.data());
+  auto run = begin;
+  wasm::bin::u32(run);
+  std::cout << "Decoding type indices..." << std::endl;
+  if (!compare(run, begin + funcs.size())) return 1;
+
+  // Modules with many types have only multi-byte indices.
+  std::string wide;
+  for (uint32_t i = 0; i < N_FUNCS; ++i) put_u32(wide, 128 + i % 16000);
+  auto wide_begin = reinterpret_cast<const byte_t*>(wide.data());
+  std::cout << "Decoding two-byte type indices..." << std::endl;
+  if (!compare(wide_begin, wide_begin + wide.size())) return 1;
+
+  std::cout << "Decoding module metadata..." << std::endl;
+  size_t n_exports = 0;
+  measure("module_info", N_IMPORTS + 2 * N_FUNCS, [&] {
+    auto info = wasm::bin::module_info(binary);
+    n_exports = info.exports.size();
+  });
+  if (n_exports != N_FUNCS) {
+    std::cout << "> Error: wrong export count!" << std::endl;
+    return 1;
+  }
+
+  std::cout << "Done." << std::endl;
+  return 0;
+}
@@ -74,14 +74,36 @@ void run() {
   run_in_store(store1.get());
   std::cout << "Live count " << live_count << std::endl;
 
+  std::cout << "Collecting store 1..." << std::endl;
+  auto before = store1->heap_stats();
+  store1->notify_memory_pressure(wasm::MemoryPressure::NONE);
+  store1->collect(wasm::CollectionKind::FULL);
+  auto after = store1->heap_stats();
+  std::cout << "> Heap used " << before.used_bytes << " -> " << after.used_bytes
+    << " of " << after.total_bytes << " bytes" << std::endl;
+  assert(after.used_bytes < before.used_bytes);
+  assert(after.used_bytes <= after.total_bytes);
+  assert(after.limit_bytes > 0);
+  assert(store1->idle_notification(100));
+  std::cout << "Live count " << live_count << std::endl;
+
   {
     std::cout << "Creating store 2..." << std::endl;
     auto store2 = wasm::Store::make(engine.get());
+    store2->set_deferred_finalizers(true);
 
     std::cout << "Running in store 2..." << std::endl;
     run_in_store(store2.get());
     std::cout << "Live count " << live_count << std::endl;
 
+    std::cout << "Running deferred finalizers..." << std::endl;
+    auto live = live_count;
+    store2->collect(wasm::CollectionKind::FULL);
+    assert(live_count == live);
+    while (store2->run_pending_finalizers(1000) > 0) {}
+    assert(live_count < live);
+    std::cout << "Live count " << live_count << std::endl;
+
     std::cout << "Deleting store 2..." << std::endl;
     std::cout << "Live count " << live_count << std::endl;
   }
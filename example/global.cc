@@ -185,6 +185,25 @@ void run() {
   check(call(get_var_f32_export).f32(), 77);
   check(call(get_var_i64_export).i64(), 78);
 
+  // Access variables through typed accessors and raw addresses.
+  std::cout << "Accessing global directly..." << std::endl;
+  check(const_f32_import->get_f32(), 1);
+  check(var_i64_export->get_i64(), 78);
+  var_f32_import->set_f32(83);
+  var_i64_export->set_i64(88);
+  check(call(get_var_f32_import).f32(), 83);
+  check(call(get_var_i64_export).i64(), 88);
+
+  auto counter = static_cast<int64_t*>(var_i64_import->raw_address());
+  if (!counter) {
+    std::cout << "> Error accessing global address!" << std::endl;
+    exit(1);
+  }
+  *counter += 10;
+  check(call(get_var_i64_import).i64(), 84);
+  call(set_var_i64_import, wasm::Val::i64(94));
+  check(*counter, 94);
+
   // Shut down.
   std::cout << "Shutting down..." << std::endl;
 }
@@ -7,6 +7,13 @@
 #include "wasm.hh"
 
 
+int finalized = 0;
+
+void finalize(void*) {
+  ++finalized;
+}
+
+
 // A function to be called from Wasm code.
 auto callback(
   const wasm::vec<wasm::Val>& args, wasm::vec<wasm::Val>& results
@@ -188,6 +195,21 @@ void run() {
   assert(val.ref() == nullptr);
   check(ref->copy(), host1.get());
 
+  // Replacing host info finalizes the previous one.
+  auto host3 = wasm::Foreign::make(store);
+  host3->set_host_info(reinterpret_cast<void*>(3), &finalize);
+  assert(host3->copy()->get_host_info() == reinterpret_cast<void*>(3));
+  host3->set_host_info(reinterpret_cast<void*>(4));
+  assert(finalized == 1);
+  assert(host3->get_host_info() == reinterpret_cast<void*>(4));
+
+  // Host functions keep their own data apart from host info.
+  assert(callback_func->get_host_info() == nullptr);
+  callback_func->set_host_info(reinterpret_cast<void*>(5), &finalize);
+  callback_func->set_host_info(reinterpret_cast<void*>(6));
+  assert(finalized == 2);
+  assert(callback_func->get_host_info() == reinterpret_cast<void*>(6));
+
   // Interact.
   std::cout << "Accessing global..." << std::endl;
   check(call_v_r(global_get), nullptr);
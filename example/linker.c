@@ -0,0 +1,132 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "wasm.h"
+
+#define own
+
+const int N_INSTANCES = 3;
+
+// A function to be called from Wasm code.
+own wasm_trap_t* hello_callback(
+  const wasm_val_vec_t* args, wasm_val_vec_t* results
+) {
+  printf("Calling back...\n");
+  printf("> Hello from instance %d!\n", args->data[0].of.i32);
+  return NULL;
+}
+
+
+int main(int argc, const char* argv[]) {
+  // Initialize.
+  printf("Initializing...\n");
+  wasm_engine_t* engine = wasm_engine_new();
+  wasm_store_t* store = wasm_store_new(engine);
+
+  // Load binary.
+  printf("Loading binary...\n");
+  FILE* file = fopen("linker.wasm", "rb");
+  if (!file) {
+    printf("> Error loading module!\n");
+    return 1;
+  }
+  fseek(file, 0L, SEEK_END);
+  size_t file_size = ftell(file);
+  fseek(file, 0L, SEEK_SET);
+  wasm_byte_vec_t binary;
+  wasm_byte_vec_new_uninitialized(&binary, file_size);
+  if (fread(binary.data, file_size, 1, file) != 1) {
+    printf("> Error loading module!\n");
+    return 1;
+  }
+  fclose(file);
+
+  // Compile.
+  printf("Compiling module...\n");
+  own wasm_module_t* module = wasm_module_new(store, &binary);
+  if (!module) {
+    printf("> Error compiling module!\n");
+    return 1;
+  }
+
+  wasm_byte_vec_delete(&binary);
+
+  // Create linker.
+  printf("Creating linker...\n");
+  own wasm_linker_t* linker = wasm_linker_new(store, module);
+  if (!linker) {
+    printf("> Error creating linker!\n");
+    return 1;
+  }
+
+  wasm_module_delete(module);
+
+  // Create external function.
+  printf("Creating callback...\n");
+  own wasm_functype_t* hello_type =
+    wasm_functype_new_1_0(wasm_valtype_new_i32());
+  own wasm_func_t* hello_func =
+    wasm_func_new(store, hello_type, hello_callback);
+
+  wasm_functype_delete(hello_type);
+
+  // Define import.
+  printf("Defining import...\n");
+  wasm_name_t env, hello;
+  wasm_name_new_from_string(&env, "env");
+  wasm_name_new_from_string(&hello, "hello");
+  if (!wasm_linker_define(linker, &env, &hello, wasm_func_as_extern(hello_func))) {
+    printf("> Error defining import!\n");
+    return 1;
+  }
+
+  wasm_name_delete(&env);
+  wasm_name_delete(&hello);
+  wasm_func_delete(hello_func);
+
+  // Instantiate and call repeatedly.
+  for (int i = 0; i < N_INSTANCES; ++i) {
+    printf("Instantiating module...\n");
+    own wasm_instance_t* instance = wasm_linker_instantiate(linker, NULL);
+    if (!instance) {
+      printf("> Error instantiating module!\n");
+      return 1;
+    }
+
+    own wasm_extern_vec_t exports;
+    wasm_instance_exports(instance, &exports);
+    if (exports.size == 0) {
+      printf("> Error accessing exports!\n");
+      return 1;
+    }
+    const wasm_func_t* run_func = wasm_extern_as_func(exports.data[0]);
+    if (run_func == NULL) {
+      printf("> Error accessing export!\n");
+      return 1;
+    }
+
+    printf("Calling export...\n");
+    wasm_val_t vals[] = { WASM_I32_VAL(i) };
+    wasm_val_vec_t args = WASM_ARRAY_VEC(vals);
+    wasm_val_vec_t results = WASM_EMPTY_VEC;
+    if (wasm_func_call(run_func, &args, &results)) {
+      printf("> Error calling function!\n");
+      return 1;
+    }
+
+    wasm_extern_vec_delete(&exports);
+    wasm_instance_delete(instance);
+  }
+
+  // Shut down.
+  printf("Shutting down...\n");
+  wasm_linker_delete(linker);
+  wasm_store_delete(store);
+  wasm_engine_delete(engine);
+
+  // All done.
+  printf("Done.\n");
+  return 0;
+}
@@ -0,0 +1,157 @@
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <cinttypes>
+
+#include "wasm.hh"
+
+const int N_INSTANCES = 3;
+
+// A function to be called from Wasm code.
+auto hello_callback(
+  const wasm::vec<wasm::Val>& args, wasm::vec<wasm::Val>& results
+) -> wasm::own<wasm::Trap> {
+  std::cout << "Calling back..." << std::endl;
+  std::cout << "> Hello from instance " << args[0].i32() << "!" << std::endl;
+  return nullptr;
+}
+
+
+void run() {
+  // Initialize.
+  std::cout << "Initializing..." << std::endl;
+  auto engine = wasm::Engine::make();
+  auto store_ = wasm::Store::make(engine.get());
+  auto store = store_.get();
+
+  // Load binary.
+  std::cout << "Loading binary..." << std::endl;
+  std::ifstream file("linker.wasm");
+  file.seekg(0, std::ios_base::end);
+  auto file_size = file.tellg();
+  file.seekg(0);
+  auto binary = wasm::vec<byte_t>::make_uninitialized(file_size);
+  file.read(binary.get(), file_size);
+  file.close();
+  if (file.fail()) {
+    std::cout << "> Error loading module!" << std::endl;
+    exit(1);
+  }
+
+  // Compile.
+  std::cout << "Compiling module..." << std::endl;
+  auto module = wasm::Module::make(store, binary);
+  if (!module) {
+    std::cout << "> Error compiling module!" << std::endl;
+    exit(1);
+  }
+
+  // Create linker.
+  std::cout << "Creating linker..." << std::endl;
+  auto linker = wasm::Linker::make(store, module.get());
+  if (!linker) {
+    std::cout << "> Error creating linker!" << std::endl;
+    exit(1);
+  }
+
+  // Check unresolved imports.
+  std::cout << "Instantiating unresolved..." << std::endl;
+  wasm::own<wasm::Trap> trap;
+  if (linker->instantiate(&trap) || !trap) {
+    std::cout << "> Error reporting unresolved import!" << std::endl;
+    exit(1);
+  }
+  std::cout << "> " << trap->message().get() << std::endl;
+
+  // Create external functions.
+  std::cout << "Creating callbacks..." << std::endl;
+  auto hello_type = wasm::FuncType::make(
+    wasm::ownvec<wasm::ValType>::make(wasm::ValType::make(wasm::ValKind::I32)),
+    wasm::ownvec<wasm::ValType>::make()
+  );
+  auto hello_func = wasm::Func::make(store, hello_type.get(), hello_callback);
+  auto wrong_type = wasm::FuncType::make(
+    wasm::ownvec<wasm::ValType>::make(), wasm::ownvec<wasm::ValType>::make()
+  );
+  auto wrong_func = wasm::Func::make(store, wrong_type.get(), hello_callback);
+
+  // Define imports.
+  std::cout << "Defining imports..." << std::endl;
+  auto env = wasm::Name::make(std::string("env"));
+  auto hello = wasm::Name::make(std::string("hello"));
+  auto missing = wasm::Name::make(std::string("missing"));
+  if (linker->define(env, hello, wrong_func.get())) {
+    std::cout << "> Error rejecting mistyped import!" << std::endl;
+    exit(1);
+  }
+  if (linker->define(env, missing, hello_func.get())) {
+    std::cout << "> Error rejecting unknown import!" << std::endl;
+    exit(1);
+  }
+  if (!linker->define(env, hello, hello_func.get())) {
+    std::cout << "> Error defining import!" << std::endl;
+    exit(1);
+  }
+
+  // Instantiate and call repeatedly.
+  for (int i = 0; i < N_INSTANCES; ++i) {
+    std::cout << "Instantiating module..." << std::endl;
+    auto instance = linker->instantiate();
+    if (!instance) {
+      std::cout << "> Error instantiating module!" << std::endl;
+      exit(1);
+    }
+
+    auto exports = instance->exports();
+    if (exports.size() == 0 || exports[0]->kind() != wasm::ExternKind::FUNC || !exports[0]->func()) {
+      std::cout << "> Error accessing export!" << std::endl;
+      exit(1);
+    }
+
+    std::cout << "Calling export..." << std::endl;
+    auto args = wasm::vec<wasm::Val>::make(wasm::Val::i32(i));
+    auto results = wasm::vec<wasm::Val>::make();
+    if (exports[0]->func()->call(args, results)) {
+      std::cout << "> Error calling function!" << std::endl;
+      exit(1);
+    }
+  }
+
+  // Instantiate in bulk, sharing the imports.
+  std::cout << "Instantiating in bulk..." << std::endl;
+  std::vector<wasm::vec<wasm::Extern*>> imports;
+  for (int i = 0; i < N_INSTANCES; ++i) {
+    imports.push_back(wasm::vec<wasm::Extern*>::make(hello_func.get()));
+  }
+  auto instances = wasm::Instance::make_many(
+    store, module.get(), imports.data(), N_INSTANCES);
+  if (!instances || instances.size() != N_INSTANCES) {
+    std::cout << "> Error instantiating in bulk!" << std::endl;
+    exit(1);
+  }
+  for (int i = 0; i < N_INSTANCES; ++i) {
+    auto run = instances[i]->export_by_index(0);
+    if (!run || !run->func()) {
+      std::cout << "> Error accessing export!" << std::endl;
+      exit(1);
+    }
+    auto args = wasm::vec<wasm::Val>::make(wasm::Val::i32(i));
+    auto results = wasm::vec<wasm::Val>::make();
+    if (run->func()->call(args, results)) {
+      std::cout << "> Error calling function!" << std::endl;
+      exit(1);
+    }
+  }
+
+  // Shut down.
+  std::cout << "Shutting down..." << std::endl;
+}
+
+
+int main(int argc, const char* argv[]) {
+  run();
+  std::cout << "Done." << std::endl;
+  return 0;
+}
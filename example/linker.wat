@@ -0,0 +1,4 @@
+(module
+  (func $hello (import "env" "hello") (param i32))
+  (func (export "run") (param i32) (call $hello (local.get 0)))
+)
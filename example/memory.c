@@ -180,11 +180,22 @@ int main(int argc, const char* argv[]) {
   check_call1(load_func, 0x1002, 6);
   check_call1(load_func, 0x1003, 5);
 
+  // Take view.
+  printf("Viewing memory...\n");
+  wasm_memory_view_t view;
+  wasm_memory_view(memory, &view);
+  check(view.size == 0x20000);
+  check(view.base[0x1003] == 5);
+  check(view.generation == wasm_store_memory_generation(store));
+
   // Grow memory.
   printf("Growing memory...\n");
   check(wasm_memory_grow(memory, 1));
   check(wasm_memory_size(memory) == 3);
   check(wasm_memory_data_size(memory) == 0x30000);
+  check(view.generation != wasm_store_memory_generation(store));
+  wasm_memory_view(memory, &view);
+  check(view.size == 0x30000);
 
   check_call1(load_func, 0x20000, 0);
   check_ok2(store_func, 0x20000, 0);
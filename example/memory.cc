@@ -1,6 +1,7 @@
 #include <iostream>
 #include <fstream>
 #include <cstdlib>
+#include <cstdio>
 #include <string>
 #include <cinttypes>
 
@@ -66,7 +67,9 @@ auto call(const wasm::Func* func, Args... xs) -> int32_t {
 void run() {
   // Initialize.
   std::cout << "Initializing..." << std::endl;
-  auto engine = wasm::Engine::make();
+  auto config = wasm::Config::make();
+  config->set_allocator(wasm::AllocatorKind::ARENA);
+  auto engine = wasm::Engine::make(std::move(config));
   auto store_ = wasm::Store::make(engine.get());
   auto store = store_.get();
 
@@ -139,11 +142,25 @@ void run() {
   check(call(load_func, 0x1002), 6);
   check(call(load_func, 0x1003), 5);
 
+  // Take view.
+  std::cout << "Viewing memory..." << std::endl;
+  auto view = memory->view();
+  check(view.size, 0x20000u);
+  check(view.base[0x1003], 5);
+  check(view.generation, store->memory_generation());
+  check_ok(store_func, 0x1003, 7);
+  check(view.base[0x1003], 7);
+  check(view.generation, store->memory_generation());
+
   // Grow memory.
   std::cout << "Growing memory..." << std::endl;
   check(memory->grow(1), true);
   check(memory->size(), 3u);
   check(memory->data_size(), 0x30000u);
+  check(view.generation != store->memory_generation(), true);
+  view = memory->view();
+  check(view.size, 0x30000u);
+  check(view.base[0x1003], 7);
 
   check(call(load_func, 0x20000), 0);
   check_ok(store_func, 0x20000, 0);
@@ -162,6 +179,141 @@ void run() {
   check(memory2->grow(1), false);
   check(memory2->grow(0), true);
 
+  // Bulk access.
+  std::cout << "Accessing memory in bulk..." << std::endl;
+  byte_t buf[4] = {1, 2, 3, 4};
+  check(memory2->write(0x100, buf, 4), true);
+  check(memory2->write(0x50000 - 2, buf, 4), false);
+  check(memory2->write(SIZE_MAX, buf, 4), false);
+  check(memory2->fill(0x104, 9, 4), true);
+  check(memory2->copy_within(0x200, 0x100, 8), true);
+  check(memory2->copy_within(0x200, 0x50000 - 4, 8), false);
+  check(memory2->copy_from(0x1000, memory, 0x1002, 2), true);
+  check(memory->copy_from(0x2ffff, memory2.get(), 0, 2), false);
+  {
+    auto other_store = wasm::Store::make(engine.get());
+    auto other = wasm::Memory::make(other_store.get(), memorytype.get());
+    check(memory2->copy_from(0, other.get(), 0, 1), false);
+  }
+
+  byte_t lo[4], hi[6];
+  wasm::MemoryIovec iovs[] = {{0x200, lo, 4}, {0x204, hi, 4}, {0x1000, hi + 4, 2}};
+  check(memory2->readv(iovs, 3), true);
+  check(lo[3], 4);
+  check(hi[0], 9);
+  check(hi[4], 6);
+  check(hi[5], 7);
+  iovs[2].offset = 0x50000;
+  check(memory2->readv(iovs, 3), false);
+  check(memory2->read(0x50000, lo, 0), true);
+  check(memory2->read(0x50000, lo, 1), false);
+
+  // Track dirty pages.
+  std::cout << "Tracking dirty pages..." << std::endl;
+  auto page = wasm::Memory::dirty_page_size();
+  auto epoch = memory2->checkpoint();
+  check(epoch != 0, true);
+  check(memory2->fill(3 * page + 1, 0x55, 1), true);
+  auto dirty = memory2->dirty_pages(epoch);
+  check(dirty.size(), (0x50000 / page + 7) / 8);
+  check((dirty[0] >> 3) & 1, 1);
+  check(dirty[0] & 1, 0);
+  check(bool(memory2->dirty_pages(epoch + 1)), false);
+
+#ifdef __linux__
+  // Map a file.
+  std::cout << "Mapping file..." << std::endl;
+  auto data_file = std::tmpfile();
+  std::string contents(0x20000, 'x');
+  std::fwrite(contents.data(), 1, contents.size(), data_file);
+  std::fflush(data_file);
+  auto memorytype3 = wasm::MemoryType::make(wasm::Limits(4));
+  wasm::MemoryMapping mapping = {fileno(data_file), 0x10000, 0x10000, 0x10000, false};
+  auto memory3 = wasm::Memory::make(store, memorytype3.get(), mapping);
+  if (!memory3) {
+    std::cout << "> Error mapping file!" << std::endl;
+    exit(1);
+  }
+  check(memory3->data()[0xffff], 0);
+  check(memory3->data()[0x10000], 'x');
+  check(memory3->data()[0x1ffff], 'x');
+  check(memory3->data()[0x20000], 0);
+  memory3->data()[0x10000] = 'y';  // private, the file stays unchanged
+  mapping.offset = 0x30000;
+  mapping.size = 0x20000;
+  check(memory3->map(mapping), false);
+  memory3.reset();
+  std::fclose(data_file);
+#endif
+
+  // Create 64-bit memory.
+  std::cout << "Creating 64-bit memory..." << std::endl;
+  auto memorytype4 = wasm::MemoryType::make(wasm::Limits(1, 4), false, true);
+  auto memory4 = wasm::Memory::make(store, memorytype4.get());
+  if (!memory4) {
+    std::cout << "> Error creating 64-bit memory!" << std::endl;
+    exit(1);
+  }
+  check(memory4->type()->is64(), true);
+  check(memory4->grow(2), true);
+  check(memory4->size(), 3u);
+  check(memory4->data_size(), size_t(0x30000));
+  check(memory4->write(0x2fffc, buf, 4), true);
+  if (sizeof(size_t) > 4) {
+    // Offsets are not truncated to 32 bits.
+    check(memory4->write(size_t(0xffffffffu) + 1, buf, 4), false);
+  }
+  check(memory4->grow(2), false);
+
+  auto memorytype5 = wasm::MemoryType::make(wasm::Limits(1, 2), true, true);
+  auto memory5 = wasm::Memory::make(store, memorytype5.get());
+  auto shared5 = memory5 ? memory5->share() : nullptr;
+  auto memory6 = shared5 ? wasm::Memory::obtain(store, shared5.get()) : nullptr;
+  if (!memory6) {
+    std::cout << "> Error sharing 64-bit memory!" << std::endl;
+    exit(1);
+  }
+  check(memory6->type()->is64(), true);
+  check(memory6->type()->shared(), true);
+
+  // Discard memory.
+  std::cout << "Discarding memory..." << std::endl;
+  check(memory4->discard(0x30000 - page, page), true);
+  check(memory4->data()[0x2fffc], 0);
+  check(memory4->discard(1, page), false);
+  check(memory4->discard(0x30000, page), false);
+  auto epoch4 = memory4->checkpoint();
+  check(memory4->discard(0, page), true);
+  auto dirty4 = memory4->dirty_pages(epoch4);
+  check(dirty4[0] & 1, 1);
+  check((dirty4[0] >> 1) & 1, 0);
+
+  // Hibernate instance.
+  std::cout << "Hibernating instance..." << std::endl;
+  check(instance->hibernate("memory.hib"), true);
+  check(memory->data()[0x1003], 0);
+  check(call(load_func, 0x1003), 0);
+  check_ok(store_func, 0x1004, 1);
+  check(instance->resume("memory.hib"), true);
+  check(call(load_func, 0x1002), 6);
+  check(call(load_func, 0x1003), 7);
+  check(call(load_func, 0x1004), 0);
+
+  // Hibernate again, over the pages mapped by resuming.
+  check(instance->hibernate("memory.hib"), true);
+  check(call(load_func, 0x1002), 0);
+  check(call(load_func, 0x1003), 0);
+  check_ok(store_func, 0x1002, 1);
+  check(instance->resume("memory.hib"), true);
+  check(call(load_func, 0x1002), 6);
+  check(call(load_func, 0x1003), 7);
+  std::remove("memory.hib");
+
+  auto stats = store->allocator_stats();
+  std::cout << "> Allocated " << stats.allocations << " buffers, "
+    << stats.reuses << " reused, peak " << stats.peak_bytes << " bytes"
+    << std::endl;
+
   // Shut down.
   std::cout << "Shutting down..." << std::endl;
 }
@@ -0,0 +1,164 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "wasm.h"
+
+#define own
+
+
+wasm_func_t* get_export_func(const wasm_extern_vec_t* exports, size_t i) {
+  if (exports->size <= i || !wasm_extern_as_func(exports->data[i])) {
+    printf("> Error accessing function export %zu!\n", i);
+    exit(1);
+  }
+  return wasm_extern_as_func(exports->data[i]);
+}
+
+
+void check(bool success) {
+  if (!success) {
+    printf("> Error, expected success\n");
+    exit(1);
+  }
+}
+
+void check_call(wasm_func_t* func, size_t i, wasm_val_t args[], int32_t expected) {
+  wasm_val_t r = WASM_INIT_VAL;
+  wasm_val_vec_t args_ = {i, args};
+  wasm_val_vec_t results = {1, &r};
+  if (wasm_func_call(func, &args_, &results) || r.of.i32 != expected) {
+    printf("> Error on result\n");
+    exit(1);
+  }
+}
+
+void check_call0(wasm_func_t* func, int32_t expected) {
+  check_call(func, 0, NULL, expected);
+}
+
+void check_call1(wasm_func_t* func, int32_t arg, int32_t expected) {
+  wasm_val_t args[] = { WASM_I32_VAL(arg) };
+  check_call(func, 1, args, expected);
+}
+
+void check_ok2(wasm_func_t* func, int32_t arg1, int32_t arg2) {
+  wasm_val_t args[] = { WASM_I32_VAL(arg1), WASM_I32_VAL(arg2) };
+  wasm_val_vec_t args_ = WASM_ARRAY_VEC(args);
+  wasm_val_vec_t results = WASM_EMPTY_VEC;
+  if (wasm_func_call(func, &args_, &results)) {
+    printf("> Error on result, expected empty\n");
+    exit(1);
+  }
+}
+
+
+int main(int argc, const char* argv[]) {
+  // Initialize.
+  printf("Initializing...\n");
+  wasm_engine_t* engine = wasm_engine_new();
+  wasm_store_t* store = wasm_store_new(engine);
+
+  // Load binary.
+  printf("Loading binary...\n");
+  FILE* file = fopen("pool.wasm", "rb");
+  if (!file) {
+    printf("> Error loading module!\n");
+    return 1;
+  }
+  fseek(file, 0L, SEEK_END);
+  size_t file_size = ftell(file);
+  fseek(file, 0L, SEEK_SET);
+  wasm_byte_vec_t binary;
+  wasm_byte_vec_new_uninitialized(&binary, file_size);
+  if (fread(binary.data, file_size, 1, file) != 1) {
+    printf("> Error loading module!\n");
+    return 1;
+  }
+  fclose(file);
+
+  // Compile.
+  printf("Compiling module...\n");
+  own wasm_module_t* module = wasm_module_new(store, &binary);
+  if (!module) {
+    printf("> Error compiling module!\n");
+    return 1;
+  }
+
+  wasm_byte_vec_delete(&binary);
+
+  // Create pool, running the start function once.
+  printf("Creating pool...\n");
+  wasm_extern_vec_t imports = WASM_EMPTY_VEC;
+  own wasm_instance_pool_t* pool =
+    wasm_instance_pool_new(store, module, &imports, 2, NULL);
+  if (!pool) {
+    printf("> Error creating pool!\n");
+    return 1;
+  }
+  check(wasm_instance_pool_size(pool) == 1);
+
+  wasm_module_delete(module);
+
+  // Acquire instances.
+  printf("Acquiring instances...\n");
+  own wasm_instance_t* instance1 = wasm_instance_pool_acquire(pool, NULL);
+  own wasm_instance_t* instance2 = wasm_instance_pool_acquire(pool, NULL);
+  if (!instance1 || !instance2) {
+    printf("> Error acquiring instance!\n");
+    return 1;
+  }
+  check(wasm_instance_pool_hits(pool) == 1);
+  check(wasm_instance_pool_misses(pool) == 1);
+
+  own wasm_extern_vec_t exports1, exports2;
+  wasm_instance_exports(instance1, &exports1);
+  wasm_instance_exports(instance2, &exports2);
+  wasm_func_t* load1 = get_export_func(&exports1, 2);
+  wasm_func_t* store1 = get_export_func(&exports1, 3);
+  wasm_func_t* load2 = get_export_func(&exports2, 2);
+
+  // Mutate one instance.
+  printf("Mutating memory...\n");
+  check_ok2(store1, 10, 99);
+  check_call1(load1, 10, 99);
+  check_call1(load2, 10, 42);
+
+  wasm_extern_vec_delete(&exports1);
+  wasm_extern_vec_delete(&exports2);
+
+  // Release and reacquire.
+  printf("Recycling instances...\n");
+  wasm_instance_pool_release(pool, instance1);
+  wasm_instance_pool_release(pool, instance2);
+  check(wasm_instance_pool_size(pool) == 2);
+  check(wasm_instance_pool_resets(pool) == 2);
+
+  own wasm_instance_t* instance = wasm_instance_pool_acquire(pool, NULL);
+  if (!instance) {
+    printf("> Error acquiring instance!\n");
+    return 1;
+  }
+  own wasm_extern_vec_t exports;
+  wasm_instance_exports(instance, &exports);
+  wasm_func_t* initialized = get_export_func(&exports, 1);
+  wasm_func_t* load = get_export_func(&exports, 2);
+  check_call0(initialized, 1);
+  check_call1(load, 10, 42);
+  check_call1(load, 0xffff, 42);
+  check(wasm_instance_pool_hits(pool) == 2);
+
+  wasm_extern_vec_delete(&exports);
+  wasm_instance_delete(instance);
+
+  // Shut down.
+  printf("Shutting down...\n");
+  wasm_instance_pool_delete(pool);
+  wasm_store_delete(store);
+  wasm_engine_delete(engine);
+
+  // All done.
+  printf("Done.\n");
+  return 0;
+}
@@ -0,0 +1,191 @@
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <string>
+#include <cinttypes>
+#include <algorithm>
+
+#include "wasm.hh"
+
+
+auto get_export_func(const wasm::ownvec<wasm::Extern>& exports, size_t i) -> const wasm::Func* {
+  if (exports.size() <= i || !exports[i]->func()) {
+    std::cout << "> Error accessing function export " << i << "!" << std::endl;
+    exit(1);
+  }
+  return exports[i]->func();
+}
+
+template<class T, class U>
+void check(T actual, U expected) {
+  if (actual != expected) {
+    std::cout << "> Error on result, expected " << expected << ", got " << actual << std::endl;
+    exit(1);
+  }
+}
+
+template<class... Args>
+void check_ok(const wasm::Func* func, Args... xs) {
+  auto args = wasm::vec<wasm::Val>::make(wasm::Val::i32(xs)...);
+  auto results = wasm::vec<wasm::Val>::make();
+  if (func->call(args, results)) {
+    std::cout << "> Error on result, expected return" << std::endl;
+    exit(1);
+  }
+}
+
+template<class... Args>
+auto call(const wasm::Func* func, Args... xs) -> int32_t {
+  auto args = wasm::vec<wasm::Val>::make(wasm::Val::i32(xs)...);
+  auto results = wasm::vec<wasm::Val>::make_uninitialized(1);
+  if (func->call(args, results)) {
+    std::cout << "> Error on result, expected return" << std::endl;
+    exit(1);
+  }
+  return results[0].i32();
+}
+
+
+void run() {
+  // Initialize.
+  std::cout << "Initializing..." << std::endl;
+  auto engine = wasm::Engine::make();
+  auto store_ = wasm::Store::make(engine.get());
+  auto store = store_.get();
+
+  // Load binary.
+  std::cout << "Loading binary..." << std::endl;
+  std::ifstream file("pool.wasm");
+  file.seekg(0, std::ios_base::end);
+  auto file_size = file.tellg();
+  file.seekg(0);
+  auto binary = wasm::vec<byte_t>::make_uninitialized(file_size);
+  file.read(binary.get(), file_size);
+  file.close();
+  if (file.fail()) {
+    std::cout << "> Error loading module!" << std::endl;
+    exit(1);
+  }
+
+  // Compile.
+  std::cout << "Compiling module..." << std::endl;
+  auto module = wasm::Module::make(store, binary);
+  if (!module) {
+    std::cout << "> Error compiling module!" << std::endl;
+    exit(1);
+  }
+
+  // Create pool, running the start function once.
+  std::cout << "Creating pool..." << std::endl;
+  auto imports = wasm::vec<wasm::Extern*>::make();
+  auto pool = wasm::InstancePool::make(store, module.get(), imports, 2);
+  if (!pool) {
+    std::cout << "> Error creating pool!" << std::endl;
+    exit(1);
+  }
+  check(pool->size(), 1u);
+
+  // Acquire instances.
+  std::cout << "Acquiring instances..." << std::endl;
+  auto instance1 = pool->acquire();
+  auto instance2 = pool->acquire();
+  if (!instance1 || !instance2) {
+    std::cout << "> Error acquiring instance!" << std::endl;
+    exit(1);
+  }
+  check(pool->size(), 0u);
+  check(pool->hits(), 1u);
+  check(pool->misses(), 1u);
+
+  {
+    auto exports1 = instance1->exports();
+    auto exports2 = instance2->exports();
+    auto initialized1 = get_export_func(exports1, 1);
+    auto load1 = get_export_func(exports1, 2);
+    auto store1 = get_export_func(exports1, 3);
+    auto load2 = get_export_func(exports2, 2);
+    check(call(initialized1), 1);
+    check(call(load2, 10), 42);
+
+    // Mutate one instance.
+    std::cout << "Mutating memory..." << std::endl;
+    check_ok(store1, 10, 99);
+    check(call(load1, 10), 99);
+    check(call(load2, 10), 42);
+  }
+
+  // Release and reacquire.
+  std::cout << "Recycling instances..." << std::endl;
+  pool->release(std::move(instance1));
+  pool->release(std::move(instance2));
+  check(pool->size(), 2u);
+  check(pool->resets(), 2u);
+  std::cout << "> Reset time " << pool->reset_nanoseconds() / pool->resets()
+    << " ns per instance" << std::endl;
+
+  for (int i = 0; i < 2; ++i) {
+    auto instance = pool->acquire();
+    if (!instance) {
+      std::cout << "> Error acquiring instance!" << std::endl;
+      exit(1);
+    }
+    auto exports = instance->exports();
+    auto initialized = get_export_func(exports, 1);
+    auto load = get_export_func(exports, 2);
+    check(call(initialized), 1);
+    check(call(load, 0), 42);
+    check(call(load, 10), 42);
+    check(call(load, 0xffff), 42);
+  }
+  check(pool->hits(), 3u);
+  check(pool->misses(), 1u);
+
+  // Drop instances whose tables have grown.
+  std::cout << "Growing tables..." << std::endl;
+  const byte_t table_bytes[] = {
+    0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00,
+    0x04, 0x04, 0x01, 0x70, 0x00, 0x01,  // table 1 funcref
+    0x07, 0x09, 0x01, 0x05, 't', 'a', 'b', 'l', 'e', 0x01, 0x00,  // export
+  };
+  auto table_binary = wasm::vec<byte_t>::make_uninitialized(sizeof(table_bytes));
+  std::copy(table_bytes, table_bytes + sizeof(table_bytes), table_binary.get());
+  auto table_module = wasm::Module::make(store, table_binary);
+  auto table_pool = table_module
+    ? wasm::InstancePool::make(store, table_module.get(), imports, 2) : nullptr;
+  if (!table_pool) {
+    std::cout << "> Error creating pool!" << std::endl;
+    exit(1);
+  }
+  {
+    auto instance = table_pool->acquire();
+    auto exports = instance->exports();
+    check(exports[0]->table()->grow(1), true);
+    table_pool->release(std::move(instance));
+  }
+  check(table_pool->size(), 0u);
+  check(table_pool->resets(), 0u);
+
+  // Refuse modules with mutable reference globals.
+  const byte_t global_bytes[] = {
+    0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00,
+    0x06, 0x06, 0x01, 0x6f, 0x01, byte_t(0xd0), 0x6f, 0x0b,  // mut externref
+  };
+  auto global_binary = wasm::vec<byte_t>::make_uninitialized(sizeof(global_bytes));
+  std::copy(global_bytes, global_bytes + sizeof(global_bytes), global_binary.get());
+  auto global_module = wasm::Module::make(store, global_binary);
+  if (!global_module) {
+    std::cout << "> Error compiling module!" << std::endl;
+    exit(1);
+  }
+  check(!wasm::InstancePool::make(store, global_module.get(), imports, 2), true);
+
+  // Shut down.
+  std::cout << "Shutting down..." << std::endl;
+}
+
+
+int main(int argc, const char* argv[]) {
+  run();
+  std::cout << "Done." << std::endl;
+  return 0;
+}
@@ -155,6 +155,43 @@ int main(int argc, const char* argv[]) {
     }
   }
 
+  // Inspect custom sections and function names.
+  printf("Inspecting custom sections...\n");
+  static const byte_t named_bytes[] = {
+    0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00,
+    0x01, 0x04, 0x01, 0x60, 0x00, 0x00,  // type () -> ()
+    0x03, 0x02, 0x01, 0x00,  // func 0
+    0x0a, 0x04, 0x01, 0x02, 0x00, 0x0b,  // code
+    0x00, 0x08, 0x04, 'm', 'e', 't', 'a', 0x01, 0x02, 0x03,  // custom "meta"
+    0x00, 0x0d, 0x04, 'n', 'a', 'm', 'e',  // custom "name"
+    0x01, 0x06, 0x01, 0x00, 0x03, 'r', 'u', 'n',  // func 0 is "run"
+  };
+  wasm_byte_vec_t named_binary;
+  wasm_byte_vec_new(&named_binary, sizeof(named_bytes), named_bytes);
+  own wasm_module_t* named = wasm_module_new(store, &named_binary);
+  wasm_byte_vec_delete(&named_binary);
+  if (!named) {
+    printf("> Error compiling named module!\n");
+    return 1;
+  }
+  own wasm_custom_section_vec_t sections;
+  wasm_module_custom_sections(named, &sections);
+  assert(sections.size == 2);
+  assert(sections.data[0].name.size == 4);
+  assert(memcmp(sections.data[0].name.data, "meta", 4) == 0);
+  assert(sections.data[0].data.size == 3);
+  assert(sections.data[0].data.data[2] == 3);
+  assert(memcmp(sections.data[1].name.data, "name", 4) == 0);
+  wasm_custom_section_vec_delete(&sections);
+  wasm_byte_span_t name;
+  wasm_module_func_name(named, 0, &name);
+  assert(name.size == 3 && memcmp(name.data, "run", 3) == 0);
+  wasm_module_func_name(named, 1, &name);
+  assert(name.data == NULL);
+  wasm_module_func_name(module, 0, &name);
+  assert(name.data == NULL);
+  wasm_module_delete(named);
+
   wasm_module_delete(module);
   wasm_instance_delete(instance);
   wasm_extern_vec_delete(&exports);
@@ -3,6 +3,7 @@
 #include <cstdlib>
 #include <string>
 #include <cinttypes>
+#include <algorithm>
 
 #include "wasm.hh"
 
@@ -116,6 +117,9 @@ void run() {
 
   for (size_t i = 0; i < exports.size(); ++i) {
     assert(exports[i]->kind() == export_types[i]->type()->kind());
+    assert(exports[i]->same(instance->export_by_index(i).get()));
+    assert(exports[i]->same(
+      instance->export_by_name(export_types[i]->name()).get()));
     std::cout << "> export " << i << " " << export_types[i]->name() << std::endl;
     std::cout << ">> initial: " << *export_types[i]->type() << std::endl;
     std::cout << ">> current: " << *exports[i]->type() << std::endl;
@@ -126,6 +130,54 @@ void run() {
     }
   }
 
+  assert(!instance->export_by_index(exports.size()));
+  assert(!instance->export_by_name(wasm::Name::make(std::string("none"))));
+
+  // Names are created once per module, not per instantiation.
+  auto names = store->names_created();
+  assert(names >= exports.size());
+  for (int i = 0; i < 100; ++i) {
+    auto again = wasm::Instance::make(store, module.get(), imports);
+    assert(again && again->exports().size() == exports.size());
+  }
+  assert(store->names_created() == names);
+
+  // Inspect custom sections and function names.
+  std::cout << "Inspecting custom sections..." << std::endl;
+  const byte_t named_bytes[] = {
+    0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00,
+    0x01, 0x04, 0x01, 0x60, 0x00, 0x00,  // type () -> ()
+    0x03, 0x02, 0x01, 0x00,  // func 0
+    0x0a, 0x04, 0x01, 0x02, 0x00, 0x0b,  // code
+    0x00, 0x08, 0x04, 'm', 'e', 't', 'a', 0x01, 0x02, 0x03,  // custom "meta"
+    0x00, 0x0d, 0x04, 'n', 'a', 'm', 'e',  // custom "name"
+    0x01, 0x06, 0x01, 0x00, 0x03, 'r', 'u', 'n',  // func 0 is "run"
+  };
+  auto named_binary = wasm::vec<byte_t>::make_uninitialized(sizeof(named_bytes));
+  std::copy(named_bytes, named_bytes + sizeof(named_bytes), named_binary.get());
+  auto named = wasm::Module::make(store, named_binary);
+  if (!named) {
+    std::cout << "> Error compiling named module!" << std::endl;
+    exit(1);
+  }
+  auto sections = named->custom_sections();
+  assert(sections.size() == 2);
+  assert(std::string(sections[0].name.data, sections[0].name.size) == "meta");
+  assert(sections[0].data.size == 3);
+  assert(sections[0].data.data[0] == 1 && sections[0].data.data[2] == 3);
+  assert(std::string(sections[1].name.data, sections[1].name.size) == "name");
+  for (size_t i = 0; i < sections.size(); ++i) {
+    std::cout << "> custom section "
+      << std::string(sections[i].name.data, sections[i].name.size)
+      << ", " << sections[i].data.size << " bytes" << std::endl;
+  }
+  auto name = named->func_name(0);
+  assert(std::string(name.data, name.size) == "run");
+  std::cout << "> func 0 " << std::string(name.data, name.size) << std::endl;
+  assert(named->func_name(1).data == nullptr);
+  assert(module->func_name(0).data == nullptr);
+  assert(module->custom_sections().size() == 0);
+
   // Shut down.
   std::cout << "Shutting down..." << std::endl;
 }
@@ -0,0 +1,165 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "wasm.h"
+
+#define own
+
+
+wasm_func_t* get_export_func(const wasm_extern_vec_t* exports, size_t i) {
+  if (exports->size <= i || !wasm_extern_as_func(exports->data[i])) {
+    printf("> Error accessing function export %zu!\n", i);
+    exit(1);
+  }
+  return wasm_extern_as_func(exports->data[i]);
+}
+
+
+void check(bool success) {
+  if (!success) {
+    printf("> Error, expected success\n");
+    exit(1);
+  }
+}
+
+void check_call(wasm_func_t* func, size_t i, wasm_val_t args[], int32_t expected) {
+  wasm_val_t r = WASM_INIT_VAL;
+  wasm_val_vec_t args_ = {i, args};
+  wasm_val_vec_t results = {1, &r};
+  if (wasm_func_call(func, &args_, &results) || r.of.i32 != expected) {
+    printf("> Error on result\n");
+    exit(1);
+  }
+}
+
+void check_call0(wasm_func_t* func, int32_t expected) {
+  check_call(func, 0, NULL, expected);
+}
+
+void check_call1(wasm_func_t* func, int32_t arg, int32_t expected) {
+  wasm_val_t args[] = { WASM_I32_VAL(arg) };
+  check_call(func, 1, args, expected);
+}
+
+void check_ok2(wasm_func_t* func, int32_t arg1, int32_t arg2) {
+  wasm_val_t args[] = { WASM_I32_VAL(arg1), WASM_I32_VAL(arg2) };
+  wasm_val_vec_t args_ = WASM_ARRAY_VEC(args);
+  wasm_val_vec_t results = WASM_EMPTY_VEC;
+  if (wasm_func_call(func, &args_, &results)) {
+    printf("> Error on result, expected empty\n");
+    exit(1);
+  }
+}
+
+
+int main(int argc, const char* argv[]) {
+  // Initialize.
+  printf("Initializing...\n");
+  wasm_engine_t* engine = wasm_engine_new();
+  wasm_store_t* store = wasm_store_new(engine);
+
+  // Load binary.
+  printf("Loading binary...\n");
+  FILE* file = fopen("snapshot.wasm", "rb");
+  if (!file) {
+    printf("> Error loading module!\n");
+    return 1;
+  }
+  fseek(file, 0L, SEEK_END);
+  size_t file_size = ftell(file);
+  fseek(file, 0L, SEEK_SET);
+  wasm_byte_vec_t binary;
+  wasm_byte_vec_new_uninitialized(&binary, file_size);
+  if (fread(binary.data, file_size, 1, file) != 1) {
+    printf("> Error loading module!\n");
+    return 1;
+  }
+  fclose(file);
+
+  // Compile.
+  printf("Compiling module...\n");
+  own wasm_module_t* module = wasm_module_new(store, &binary);
+  if (!module) {
+    printf("> Error compiling module!\n");
+    return 1;
+  }
+
+  wasm_byte_vec_delete(&binary);
+
+  // Instantiate, running the start function.
+  printf("Instantiating module...\n");
+  wasm_extern_vec_t imports = WASM_EMPTY_VEC;
+  own wasm_instance_t* instance =
+    wasm_instance_new(store, module, &imports, NULL);
+  if (!instance) {
+    printf("> Error instantiating module!\n");
+    return 1;
+  }
+
+  own wasm_extern_vec_t exports;
+  wasm_instance_exports(instance, &exports);
+  wasm_func_t* store_func = get_export_func(&exports, 3);
+  check_ok2(store_func, 10, 7);
+
+  // Take snapshot.
+  printf("Taking snapshot...\n");
+  own wasm_snapshot_t* snapshot = wasm_instance_snapshot(instance);
+  if (!snapshot) {
+    printf("> Error taking snapshot!\n");
+    return 1;
+  }
+  check(wasm_snapshot_memory_size(snapshot) == 0x10000);
+
+  wasm_extern_vec_delete(&exports);
+  wasm_instance_delete(instance);
+  wasm_module_delete(module);
+
+  // Instantiate from snapshot.
+  printf("Instantiating from snapshot...\n");
+  own wasm_instance_t* instance1 =
+    wasm_instance_new_from_snapshot(store, snapshot, &imports, NULL);
+  own wasm_instance_t* instance2 =
+    wasm_instance_new_from_snapshot(store, snapshot, &imports, NULL);
+  if (!instance1 || !instance2) {
+    printf("> Error instantiating from snapshot!\n");
+    return 1;
+  }
+
+  own wasm_extern_vec_t exports1, exports2;
+  wasm_instance_exports(instance1, &exports1);
+  wasm_instance_exports(instance2, &exports2);
+  wasm_func_t* initialized1 = get_export_func(&exports1, 1);
+  wasm_func_t* load1 = get_export_func(&exports1, 2);
+  wasm_func_t* store1 = get_export_func(&exports1, 3);
+  wasm_func_t* load2 = get_export_func(&exports2, 2);
+
+  // Check state.
+  printf("Checking state...\n");
+  check_call0(initialized1, 1);
+  check_call1(load1, 0, 42);
+  check_call1(load1, 0xffff, 42);
+  check_call1(load1, 10, 7);
+
+  // Mutate one copy.
+  printf("Mutating memory...\n");
+  check_ok2(store1, 10, 99);
+  check_call1(load1, 10, 99);
+  check_call1(load2, 10, 7);
+
+  wasm_extern_vec_delete(&exports1);
+  wasm_extern_vec_delete(&exports2);
+  wasm_instance_delete(instance1);
+  wasm_instance_delete(instance2);
+
+  // Shut down.
+  printf("Shutting down...\n");
+  wasm_snapshot_delete(snapshot);
+  wasm_store_delete(store);
+  wasm_engine_delete(engine);
+
+  // All done.
+  printf("Done.\n");
+  return 0;
+}
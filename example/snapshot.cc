@@ -0,0 +1,158 @@
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <cstdio>
+#include <string>
+#include <cinttypes>
+
+#include "wasm.hh"
+
+
+auto get_export_func(const wasm::ownvec<wasm::Extern>& exports, size_t i) -> const wasm::Func* {
+  if (exports.size() <= i || !exports[i]->func()) {
+    std::cout << "> Error accessing function export " << i << "!" << std::endl;
+    exit(1);
+  }
+  return exports[i]->func();
+}
+
+template<class T, class U>
+void check(T actual, U expected) {
+  if (actual != expected) {
+    std::cout << "> Error on result, expected " << expected << ", got " << actual << std::endl;
+    exit(1);
+  }
+}
+
+template<class... Args>
+void check_ok(const wasm::Func* func, Args... xs) {
+  auto args = wasm::vec<wasm::Val>::make(wasm::Val::i32(xs)...);
+  auto results = wasm::vec<wasm::Val>::make();
+  if (func->call(args, results)) {
+    std::cout << "> Error on result, expected return" << std::endl;
+    exit(1);
+  }
+}
+
+template<class... Args>
+auto call(const wasm::Func* func, Args... xs) -> int32_t {
+  auto args = wasm::vec<wasm::Val>::make(wasm::Val::i32(xs)...);
+  auto results = wasm::vec<wasm::Val>::make_uninitialized(1);
+  if (func->call(args, results)) {
+    std::cout << "> Error on result, expected return" << std::endl;
+    exit(1);
+  }
+  return results[0].i32();
+}
+
+
+void run() {
+  // Initialize.
+  std::cout << "Initializing..." << std::endl;
+  auto engine = wasm::Engine::make();
+  auto store_ = wasm::Store::make(engine.get());
+  auto store = store_.get();
+
+  // Load binary.
+  std::cout << "Loading binary..." << std::endl;
+  std::ifstream file("snapshot.wasm");
+  file.seekg(0, std::ios_base::end);
+  auto file_size = file.tellg();
+  file.seekg(0);
+  auto binary = wasm::vec<byte_t>::make_uninitialized(file_size);
+  file.read(binary.get(), file_size);
+  file.close();
+  if (file.fail()) {
+    std::cout << "> Error loading module!" << std::endl;
+    exit(1);
+  }
+
+  // Compile.
+  std::cout << "Compiling module..." << std::endl;
+  auto module = wasm::Module::make(store, binary);
+  if (!module) {
+    std::cout << "> Error compiling module!" << std::endl;
+    exit(1);
+  }
+
+  // Instantiate, running the start function.
+  std::cout << "Instantiating module..." << std::endl;
+  auto imports = wasm::vec<wasm::Extern*>::make();
+  auto instance = wasm::Instance::make(store, module.get(), imports);
+  if (!instance) {
+    std::cout << "> Error instantiating module!" << std::endl;
+    exit(1);
+  }
+
+  auto exports = instance->exports();
+  auto initialized = get_export_func(exports, 1);
+  auto load = get_export_func(exports, 2);
+  auto store_func = get_export_func(exports, 3);
+  check(call(initialized), 1);
+  check_ok(store_func, 10, 7);
+
+  // Take snapshot.
+  std::cout << "Taking snapshot..." << std::endl;
+  auto snapshot = instance->snapshot();
+  if (!snapshot) {
+    std::cout << "> Error taking snapshot!" << std::endl;
+    exit(1);
+  }
+  check(snapshot->memory_size(), 0x10000u);
+
+  // Instantiate from snapshot.
+  std::cout << "Instantiating from snapshot..." << std::endl;
+  auto instance1 = wasm::Instance::make_from_snapshot(store, snapshot.get(), imports);
+  auto instance2 = wasm::Instance::make_from_snapshot(store, snapshot.get(), imports);
+  if (!instance1 || !instance2) {
+    std::cout << "> Error instantiating from snapshot!" << std::endl;
+    exit(1);
+  }
+
+  auto store2 = wasm::Store::make(engine.get());
+  check(!wasm::Instance::make_from_snapshot(store2.get(), snapshot.get(), imports), true);
+
+  auto exports1 = instance1->exports();
+  auto exports2 = instance2->exports();
+  auto initialized1 = get_export_func(exports1, 1);
+  auto load1 = get_export_func(exports1, 2);
+  auto store1 = get_export_func(exports1, 3);
+  auto load2 = get_export_func(exports2, 2);
+
+  // Check state.
+  std::cout << "Checking state..." << std::endl;
+  check(call(initialized1), 1);
+  check(call(load1, 0), 42);
+  check(call(load1, 0xffff), 42);
+  check(call(load1, 10), 7);
+
+  // Mutate one copy.
+  std::cout << "Mutating memory..." << std::endl;
+  check_ok(store1, 10, 99);
+  check(call(load1, 10), 99);
+  check(call(load2, 10), 7);
+  check(call(load, 10), 7);
+
+  // Hibernate the mutated copy, whose memory is mapped from the snapshot.
+  std::cout << "Hibernating instance..." << std::endl;
+  check(instance1->hibernate("snapshot.hib"), true);
+  check(call(load1, 0), 0);
+  check(call(load1, 10), 0);
+  check_ok(store1, 20, 5);
+  check(instance1->resume("snapshot.hib"), true);
+  check(call(load1, 0), 42);
+  check(call(load1, 10), 99);
+  check(call(load1, 20), 42);
+  check(call(load2, 10), 7);
+  std::remove("snapshot.hib");
+
+  // Shut down.
+  std::cout << "Shutting down..." << std::endl;
+}
+
+
+int main(int argc, const char* argv[]) {
+  run();
+  std::cout << "Done." << std::endl;
+  return 0;
+}
@@ -0,0 +1,17 @@
+(module
+  (memory (export "memory") 1)
+  (global $initialized (mut i32) (i32.const 0))
+
+  (func $init
+    (memory.fill (i32.const 0) (i32.const 42) (i32.const 0x10000))
+    (global.set $initialized (i32.const 1))
+  )
+
+  (func (export "initialized") (result i32) (global.get $initialized))
+  (func (export "load") (param i32) (result i32) (i32.load8_u (local.get 0)))
+  (func (export "store") (param i32 i32)
+    (i32.store8 (local.get 0) (local.get 1))
+  )
+
+  (start $init)
+)
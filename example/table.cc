@@ -3,6 +3,7 @@
 #include <cstdlib>
 #include <string>
 #include <cinttypes>
+#include <vector>
 
 #include "wasm.hh"
 
@@ -181,6 +182,69 @@ void run() {
   check(! table2->grow(1));
   check(table2->grow(0));
 
+  // Access tables in bulk.
+  std::cout << "Accessing tables in bulk..." << std::endl;
+  check(table2->fill(0, 5, h.get()));
+  check(! table2->fill(3, 3, nullptr));
+  check(table2->get(4) != nullptr);
+  check(table2->fill(4, 1, nullptr));
+  check(table2->get(4) == nullptr);
+
+  check(table->copy_from(7, table2.get(), 2, 3));
+  check(! table->copy_from(8, table2.get(), 0, 3));
+  check(call(call_indirect, wasm::Val::i32(6), wasm::Val::i32(8)).i32(), -6);
+  check_trap(call_indirect, wasm::Val::i32(0), wasm::Val::i32(9));
+  check(table->copy_from(1, table, 0, 3));
+  auto other_store = wasm::Store::make(engine.get());
+  auto other_table = wasm::Table::make(other_store.get(), tabletype.get());
+  check(! table->copy_from(0, other_table.get(), 0, 1));
+  check(call(call_indirect, wasm::Val::i32(7), wasm::Val::i32(1)).i32(), 666);
+  check_trap(call_indirect, wasm::Val::i32(0), wasm::Val::i32(2));
+  check(call(call_indirect, wasm::Val::i32(5), wasm::Val::i32(3)).i32(), 5);
+
+  auto refs = table->get_range(0, 4);
+  check(refs.size(), 4u);
+  check(refs[0] != nullptr);
+  check(refs[2] == nullptr);
+  check(! table->get_range(8, 3));
+  const wasm::Ref* range[] = {f, nullptr};
+  check(table->set_range(8, range, 2));
+  check(! table->set_range(9, range, 2));
+  check(call(call_indirect, wasm::Val::i32(5), wasm::Val::i32(8)).i32(), 5);
+  check_trap(call_indirect, wasm::Val::i32(0), wasm::Val::i32(9));
+
+  // Call table entries directly.
+  std::cout << "Calling table entries..." << std::endl;
+  auto args = wasm::vec<wasm::Val>::make(wasm::Val::i32(7));
+  auto results = wasm::vec<wasm::Val>::make_uninitialized(1);
+  check(table->call(0, args, results) == nullptr);
+  check(results[0].i32(), 666);
+  check(table->call(8, args, results) == nullptr);
+  check(results[0].i32(), 7);
+  check(table->call(2, args, results) != nullptr);
+  check(table->call(10, args, results) != nullptr);
+  auto no_args = wasm::vec<wasm::Val>::make();
+  check(table->call(8, no_args, results) != nullptr);
+  auto i64_args = wasm::vec<wasm::Val>::make(wasm::Val::i64(7));
+  check(table->call(8, i64_args, results) != nullptr);
+
+  // Churn references.
+  std::cout << "Copying references..." << std::endl;
+  auto before = store->handle_stats();
+  {
+    std::vector<wasm::own<wasm::Func>> copies;
+    for (int n = 0; n < 10000; ++n) copies.push_back(f->copy());
+  }
+  auto after = store->handle_stats();
+  check(after.live, before.live);
+  check(after.high_water >= before.live + 10000, true);
+  check(after.slab_allocations > before.slab_allocations, true);
+  check(after.slab_releases > before.slab_releases, true);
+  check(after.slabs <= before.slabs + 1, true);
+  std::cout << "> Handles: " << after.live << " live, " << after.capacity
+    << " capacity in " << after.slabs << " slabs, peak " << after.high_water
+    << std::endl;
+
   // Shut down.
   std::cout << "Shutting down..." << std::endl;
 }
@@ -0,0 +1,31 @@
+(module
+  (memory (import "" "memory") 16 16 shared)
+
+  ;; Increments the n words from address offset, reps times over, then
+  ;; atomically adds the number of increments to the counter at address 0.
+  (func (export "work") (param $offset i32) (param $n i32) (param $reps i32)
+    (local $end i32) (local $p i32) (local $r i32)
+    (local.set $end
+      (i32.add (local.get $offset) (i32.shl (local.get $n) (i32.const 2))))
+    (local.set $r (local.get $reps))
+    (block $done
+      (loop $rep
+        (br_if $done (i32.eqz (local.get $r)))
+        (local.set $p (local.get $offset))
+        (block $next
+          (loop $word
+            (br_if $next (i32.ge_u (local.get $p) (local.get $end)))
+            (i32.store (local.get $p)
+              (i32.add (i32.load (local.get $p)) (i32.const 1)))
+            (local.set $p (i32.add (local.get $p) (i32.const 4)))
+            (br $word)
+          )
+        )
+        (local.set $r (i32.sub (local.get $r) (i32.const 1)))
+        (br $rep)
+      )
+    )
+    (drop (i32.atomic.rmw.add (i32.const 0)
+      (i32.mul (local.get $n) (local.get $reps))))
+  )
+)
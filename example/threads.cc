@@ -2,12 +2,21 @@
 #include <fstream>
 #include <thread>
 #include <mutex>
+#include <chrono>
+#include <cstring>
+#include <vector>
 
 #include "wasm.hh"
 
 const int N_THREADS = 10;
 const int N_REPS = 3;
 
+// Scaling benchmark: each thread increments its own page of a shared
+// memory, so ideally the time stays flat as threads are added.
+const int MAX_WORKERS = 8;
+const int N_WORDS = wasm::Memory::page_size / 4;
+const int N_WORK_REPS = 2000;
+
 // A function to be called from Wasm code.
 auto callback(
   void* env, const wasm::vec<wasm::Val>& args, wasm::vec<wasm::Val>& results
@@ -76,21 +85,72 @@ void run(
   }
 }
 
-int main(int argc, const char *argv[]) {
-  // Initialize.
-  std::cout << "Initializing..." << std::endl;
-  auto engine = wasm::Engine::make();
+void work(
+  wasm::Engine* engine, const wasm::Shared<wasm::Module>* shared_module,
+  const wasm::Shared<wasm::Memory>* shared_memory, std::mutex* mutex, int id
+) {
+  auto store_ = wasm::Store::make(engine);
+  auto store = store_.get();
 
-  // Load binary.
-  std::cout << "Loading binary..." << std::endl;
-  std::ifstream file("threads.wasm");
+  // Obtain module and memory.
+  auto module = wasm::Module::obtain(store, shared_module);
+  auto memory = wasm::Memory::obtain(store, shared_memory);
+  if (!module || !memory) {
+    std::lock_guard<std::mutex> lock(*mutex);
+    std::cout << "> Error obtaining module or memory!" << std::endl;
+    exit(1);
+  }
+
+  // Instantiate.
+  auto imports = wasm::vec<wasm::Extern*>::make(memory.get());
+  auto instance = wasm::Instance::make(store, module.get(), imports);
+  if (!instance) {
+    std::lock_guard<std::mutex> lock(*mutex);
+    std::cout << "> Error instantiating module!" << std::endl;
+    exit(1);
+  }
+  auto exports = instance->exports();
+  if (exports.size() == 0 || !exports[0]->func()) {
+    std::lock_guard<std::mutex> lock(*mutex);
+    std::cout << "> Error accessing export!" << std::endl;
+    exit(1);
+  }
+
+  // Work on page id + 1, page 0 holds the counter.
+  auto args = wasm::vec<wasm::Val>::make(
+    wasm::Val::i32((id + 1) * wasm::Memory::page_size),
+    wasm::Val::i32(N_WORDS), wasm::Val::i32(N_WORK_REPS));
+  auto results = wasm::vec<wasm::Val>::make();
+  if (exports[0]->func()->call(args, results)) {
+    std::lock_guard<std::mutex> lock(*mutex);
+    std::cout << "> Error calling function!" << std::endl;
+    exit(1);
+  }
+}
+
+
+auto load(const char* path) -> wasm::vec<byte_t> {
+  std::ifstream file(path);
   file.seekg(0, std::ios_base::end);
   auto file_size = file.tellg();
   file.seekg(0);
   auto binary = wasm::vec<byte_t>::make_uninitialized(file_size);
   file.read(binary.get(), file_size);
   file.close();
-  if (file.fail()) {
+  if (file.fail()) return wasm::vec<byte_t>::invalid();
+  return binary;
+}
+
+
+int main(int argc, const char *argv[]) {
+  // Initialize.
+  std::cout << "Initializing..." << std::endl;
+  auto engine = wasm::Engine::make();
+
+  // Load binary.
+  std::cout << "Loading binary..." << std::endl;
+  auto binary = load("threads.wasm");
+  if (!binary) {
     std::cout << "> Error loading module!" << std::endl;
     return 1;
   }
@@ -121,5 +181,54 @@ int main(int argc, const char *argv[]) {
     threads[i].join();
   }
 
+  // Create and share memory.
+  std::cout << "Creating and sharing memory..." << std::endl;
+  auto memory_type = wasm::MemoryType::make(
+    wasm::Limits(MAX_WORKERS + 1, MAX_WORKERS + 1), true);
+  auto memory = wasm::Memory::make(store.get(), memory_type.get());
+  if (!memory || !memory->type()->shared()) {
+    std::cout << "> Error creating shared memory!" << std::endl;
+    return 1;
+  }
+  auto shared_memory = memory->share();
+
+  std::cout << "Loading, compiling and sharing worker module..." << std::endl;
+  auto work_binary = load("threads-memory.wasm");
+  auto work_module = work_binary
+    ? wasm::Module::make(store.get(), work_binary) : nullptr;
+  if (!work_module) {
+    std::cout << "> Error compiling module!" << std::endl;
+    return 1;
+  }
+  auto shared_work_module = work_module->share();
+
+  // Run the workload with increasing numbers of threads.
+  std::cout << "Running scaling benchmark..." << std::endl;
+  uint32_t expected = 0;
+  for (int n = 1; n <= MAX_WORKERS; n *= 2) {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (int i = 0; i < n; ++i) {
+      workers.emplace_back(work, engine.get(), shared_work_module.get(),
+        shared_memory.get(), &mutex, i);
+    }
+    for (auto& worker : workers) worker.join();
+    auto end = std::chrono::steady_clock::now();
+    auto ms = std::chrono::duration<double, std::milli>(end - start).count();
+    auto increments = static_cast<double>(n) * N_WORDS * N_WORK_REPS;
+    expected += static_cast<uint32_t>(n) * N_WORDS * N_WORK_REPS;
+    std::cout << "> " << n << " threads: " << ms << " ms, "
+      << increments / ms / 1e3 << " M increments/s" << std::endl;
+  }
+
+  // Check the counter, which all threads updated atomically.
+  uint32_t counter;
+  std::memcpy(&counter, memory->data(), sizeof(counter));
+  if (counter != expected) {
+    std::cout << "> Error: counter is " << counter << ", expected "
+      << expected << "!" << std::endl;
+    return 1;
+  }
+
   return 0;
 }
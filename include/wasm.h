@@ -130,6 +130,42 @@ WASM_DECLARE_OWN(config)
 
 WASM_API_EXTERN own wasm_config_t* wasm_config_new(void);
 
+typedef uint8_t wasm_allocator_kind_t;
+enum wasm_allocator_kind_enum {
+  WASM_ALLOCATOR_DEFAULT,
+  WASM_ALLOCATOR_HUGE_PAGE,
+  WASM_ALLOCATOR_ARENA,
+  WASM_ALLOCATOR_CUSTOM,
+};
+
+typedef struct wasm_allocator_t {
+  void* env;
+  void* (*allocate)(void* env, size_t size);  // zeroed
+  void (*free)(void* env, void* data, size_t size);
+} wasm_allocator_t;
+
+typedef struct wasm_allocator_stats_t {
+  size_t allocations;
+  size_t frees;
+  size_t reuses;
+  size_t live_bytes;
+  size_t peak_bytes;
+  size_t huge_page_bytes;
+  size_t advised_huge_page_bytes;
+} wasm_allocator_stats_t;
+
+typedef struct wasm_handle_stats_t {
+  size_t slabs;
+  size_t capacity;
+  size_t live;
+  size_t high_water;
+  size_t slab_allocations;
+  size_t slab_releases;
+} wasm_handle_stats_t;
+
+WASM_API_EXTERN void wasm_config_set_allocator_kind(wasm_config_t*, wasm_allocator_kind_t);
+WASM_API_EXTERN void wasm_config_set_allocator(wasm_config_t*, const wasm_allocator_t*);
+
 // Embedders may provide custom functions for manipulating configs.
 
 
@@ -147,6 +183,40 @@ WASM_DECLARE_OWN(store)
 
 WASM_API_EXTERN own wasm_store_t* wasm_store_new(wasm_engine_t*);
 
+typedef struct wasm_heap_stats_t {
+  size_t used_bytes;
+  size_t total_bytes;
+  size_t limit_bytes;
+  size_t external_bytes;
+  size_t code_bytes;
+} wasm_heap_stats_t;
+
+typedef uint8_t wasm_memory_pressure_t;
+enum wasm_memory_pressure_enum {
+  WASM_MEMORY_PRESSURE_NONE,
+  WASM_MEMORY_PRESSURE_MODERATE,
+  WASM_MEMORY_PRESSURE_CRITICAL,
+};
+
+typedef uint8_t wasm_collection_kind_t;
+enum wasm_collection_kind_enum {
+  WASM_COLLECTION_MINOR,
+  WASM_COLLECTION_FULL,
+};
+
+WASM_API_EXTERN uint64_t wasm_store_memory_generation(const wasm_store_t*);
+WASM_API_EXTERN void wasm_store_allocator_stats(const wasm_store_t*, wasm_allocator_stats_t* out);
+WASM_API_EXTERN void wasm_store_handle_stats(const wasm_store_t*, wasm_handle_stats_t* out);
+WASM_API_EXTERN size_t wasm_store_names_created(const wasm_store_t*);
+
+WASM_API_EXTERN void wasm_store_heap_stats(const wasm_store_t*, wasm_heap_stats_t* out);
+WASM_API_EXTERN void wasm_store_notify_memory_pressure(wasm_store_t*, wasm_memory_pressure_t);
+WASM_API_EXTERN bool wasm_store_idle_notification(wasm_store_t*, uint32_t budget_ms);
+WASM_API_EXTERN void wasm_store_collect(wasm_store_t*, wasm_collection_kind_t);
+
+WASM_API_EXTERN void wasm_store_set_deferred_finalizers(wasm_store_t*, bool);
+WASM_API_EXTERN size_t wasm_store_run_pending_finalizers(wasm_store_t*, size_t budget);
+
 
 ///////////////////////////////////////////////////////////////////////////////
 // Type Representations
@@ -247,8 +317,12 @@ WASM_API_EXTERN const wasm_limits_t* wasm_tabletype_limits(const wasm_tabletype_
 WASM_DECLARE_TYPE(memorytype)
 
 WASM_API_EXTERN own wasm_memorytype_t* wasm_memorytype_new(const wasm_limits_t*);
+WASM_API_EXTERN own wasm_memorytype_t* wasm_memorytype_new_shared(const wasm_limits_t*);
+WASM_API_EXTERN own wasm_memorytype_t* wasm_memorytype_new_64(const wasm_limits_t*, bool shared);
 
 WASM_API_EXTERN const wasm_limits_t* wasm_memorytype_limits(const wasm_memorytype_t*);
+WASM_API_EXTERN bool wasm_memorytype_is_shared(const wasm_memorytype_t*);
+WASM_API_EXTERN bool wasm_memorytype_is_64(const wasm_memorytype_t*);
 
 
 // Extern Types
@@ -401,6 +475,20 @@ WASM_API_EXTERN own wasm_foreign_t* wasm_foreign_new(wasm_store_t*);
 
 WASM_DECLARE_SHARABLE_REF(module)
 
+// Views into a module's binary, valid as long as the module is alive.
+
+typedef struct wasm_byte_span_t {
+  const wasm_byte_t* data;
+  size_t size;
+} wasm_byte_span_t;
+
+typedef struct wasm_custom_section_t {
+  wasm_byte_span_t name;
+  wasm_byte_span_t data;
+} wasm_custom_section_t;
+
+WASM_DECLARE_VEC(custom_section, )
+
 WASM_API_EXTERN own wasm_module_t* wasm_module_new(
   wasm_store_t*, const wasm_byte_vec_t* binary);
 
@@ -409,6 +497,9 @@ WASM_API_EXTERN bool wasm_module_validate(wasm_store_t*, const wasm_byte_vec_t*
 WASM_API_EXTERN void wasm_module_imports(const wasm_module_t*, own wasm_importtype_vec_t* out);
 WASM_API_EXTERN void wasm_module_exports(const wasm_module_t*, own wasm_exporttype_vec_t* out);
 
+WASM_API_EXTERN void wasm_module_custom_sections(const wasm_module_t*, own wasm_custom_section_vec_t* out);
+WASM_API_EXTERN void wasm_module_func_name(const wasm_module_t*, uint32_t index, wasm_byte_span_t* out);  // null data if unnamed
+
 WASM_API_EXTERN void wasm_module_serialize(const wasm_module_t*, own wasm_byte_vec_t* out);
 WASM_API_EXTERN own wasm_module_t* wasm_module_deserialize(wasm_store_t*, const wasm_byte_vec_t*);
 
@@ -448,6 +539,16 @@ WASM_API_EXTERN own wasm_globaltype_t* wasm_global_type(const wasm_global_t*);
 WASM_API_EXTERN void wasm_global_get(const wasm_global_t*, own wasm_val_t* out);
 WASM_API_EXTERN void wasm_global_set(wasm_global_t*, const wasm_val_t*);
 
+WASM_API_EXTERN int32_t wasm_global_get_i32(const wasm_global_t*);
+WASM_API_EXTERN int64_t wasm_global_get_i64(const wasm_global_t*);
+WASM_API_EXTERN float32_t wasm_global_get_f32(const wasm_global_t*);
+WASM_API_EXTERN float64_t wasm_global_get_f64(const wasm_global_t*);
+WASM_API_EXTERN void wasm_global_set_i32(wasm_global_t*, int32_t);
+WASM_API_EXTERN void wasm_global_set_i64(wasm_global_t*, int64_t);
+WASM_API_EXTERN void wasm_global_set_f32(wasm_global_t*, float32_t);
+WASM_API_EXTERN void wasm_global_set_f64(wasm_global_t*, float64_t);
+WASM_API_EXTERN void* wasm_global_raw_address(const wasm_global_t*);
+
 
 // Table Instances
 
@@ -466,10 +567,25 @@ WASM_API_EXTERN bool wasm_table_set(wasm_table_t*, wasm_table_size_t index, wasm
 WASM_API_EXTERN wasm_table_size_t wasm_table_size(const wasm_table_t*);
 WASM_API_EXTERN bool wasm_table_grow(wasm_table_t*, wasm_table_size_t delta, wasm_ref_t* init);
 
+// Fills out[0..n), or nothing on failure.
+WASM_API_EXTERN bool wasm_table_get_range(
+  const wasm_table_t*, wasm_table_size_t start, own wasm_ref_t* out[], wasm_table_size_t n);
+WASM_API_EXTERN bool wasm_table_set_range(
+  wasm_table_t*, wasm_table_size_t start, wasm_ref_t* const refs[], wasm_table_size_t n);
+WASM_API_EXTERN bool wasm_table_fill(
+  wasm_table_t*, wasm_table_size_t start, wasm_table_size_t n, wasm_ref_t*);
+WASM_API_EXTERN bool wasm_table_copy_from(
+  wasm_table_t*, wasm_table_size_t dst, const wasm_table_t* src,
+  wasm_table_size_t src_start, wasm_table_size_t n);
+
+WASM_API_EXTERN own wasm_trap_t* wasm_table_call(
+  const wasm_table_t*, wasm_table_size_t index,
+  const wasm_val_vec_t* args, wasm_val_vec_t* results);
+
 
 // Memory Instances
 
-WASM_DECLARE_REF(memory)
+WASM_DECLARE_SHARABLE_REF(memory)
 
 typedef uint32_t wasm_memory_pages_t;
 
@@ -477,6 +593,20 @@ static const size_t MEMORY_PAGE_SIZE = 0x10000;
 
 WASM_API_EXTERN own wasm_memory_t* wasm_memory_new(wasm_store_t*, const wasm_memorytype_t*);
 
+// Offsets and size must be multiples of the host page size.
+typedef struct wasm_memory_mapping_t {
+  int fd;
+  uint64_t file_offset;
+  size_t offset;
+  size_t size;
+  bool shared;
+} wasm_memory_mapping_t;
+
+WASM_API_EXTERN own wasm_memory_t* wasm_memory_new_mapped(
+  wasm_store_t*, const wasm_memorytype_t*, const wasm_memory_mapping_t*);
+WASM_API_EXTERN bool wasm_memory_map(wasm_memory_t*, const wasm_memory_mapping_t*);
+WASM_API_EXTERN bool wasm_memory_discard(wasm_memory_t*, size_t offset, size_t size);
+
 WASM_API_EXTERN own wasm_memorytype_t* wasm_memory_type(const wasm_memory_t*);
 
 WASM_API_EXTERN byte_t* wasm_memory_data(wasm_memory_t*);
@@ -485,6 +615,37 @@ WASM_API_EXTERN size_t wasm_memory_data_size(const wasm_memory_t*);
 WASM_API_EXTERN wasm_memory_pages_t wasm_memory_size(const wasm_memory_t*);
 WASM_API_EXTERN bool wasm_memory_grow(wasm_memory_t*, wasm_memory_pages_t delta);
 
+// Valid while generation equals wasm_store_memory_generation.
+typedef struct wasm_memory_view_t {
+  wasm_byte_t* base;
+  size_t size;
+  uint64_t generation;
+} wasm_memory_view_t;
+
+WASM_API_EXTERN void wasm_memory_view(const wasm_memory_t*, wasm_memory_view_t* out);
+
+// One bit per host page written since the epoch returned by checkpoint.
+WASM_API_EXTERN size_t wasm_memory_dirty_page_size(void);
+WASM_API_EXTERN uint64_t wasm_memory_checkpoint(wasm_memory_t*);
+WASM_API_EXTERN void wasm_memory_dirty_pages(
+  const wasm_memory_t*, uint64_t since_epoch, own wasm_byte_vec_t* out);
+
+// Bounds-checked bulk access, failing without effect if out of bounds.
+typedef struct wasm_memory_iovec_t {
+  size_t offset;
+  wasm_byte_t* data;
+  size_t size;
+} wasm_memory_iovec_t;
+
+WASM_API_EXTERN bool wasm_memory_read(const wasm_memory_t*, size_t offset, wasm_byte_t* out, size_t size);
+WASM_API_EXTERN bool wasm_memory_write(wasm_memory_t*, size_t offset, const wasm_byte_t* data, size_t size);
+WASM_API_EXTERN bool wasm_memory_fill(wasm_memory_t*, size_t offset, wasm_byte_t value, size_t size);
+WASM_API_EXTERN bool wasm_memory_copy_within(wasm_memory_t*, size_t dst, size_t src, size_t size);
+WASM_API_EXTERN bool wasm_memory_copy_from(
+  wasm_memory_t*, size_t dst, const wasm_memory_t* src, size_t src_offset, size_t size);
+WASM_API_EXTERN bool wasm_memory_readv(const wasm_memory_t*, const wasm_memory_iovec_t[], size_t n);
+WASM_API_EXTERN bool wasm_memory_writev(wasm_memory_t*, const wasm_memory_iovec_t[], size_t n);
+
 
 // Externals
 
@@ -524,7 +685,68 @@ WASM_API_EXTERN own wasm_instance_t* wasm_instance_new(
   own wasm_trap_t**
 );
 
+// Fills out[0..n), or nothing on failure.
+WASM_API_EXTERN bool wasm_instance_new_many(
+  wasm_store_t*, const wasm_module_t*, const wasm_extern_vec_t imports[],
+  size_t n, own wasm_instance_t* out[], own wasm_trap_t**
+);
+
 WASM_API_EXTERN void wasm_instance_exports(const wasm_instance_t*, own wasm_extern_vec_t* out);
+WASM_API_EXTERN own wasm_extern_t* wasm_instance_export_by_name(const wasm_instance_t*, const wasm_name_t*);
+WASM_API_EXTERN own wasm_extern_t* wasm_instance_export_by_index(const wasm_instance_t*, size_t index);
+
+
+// Instance Snapshots
+
+WASM_DECLARE_OWN(snapshot)
+
+WASM_API_EXTERN size_t wasm_snapshot_memory_size(const wasm_snapshot_t*);
+
+WASM_API_EXTERN own wasm_snapshot_t* wasm_instance_snapshot(const wasm_instance_t*);
+WASM_API_EXTERN own wasm_instance_t* wasm_instance_new_from_snapshot(
+  wasm_store_t*, const wasm_snapshot_t*, const wasm_extern_vec_t* imports,
+  own wasm_trap_t**
+);
+
+
+// Instance Hibernation
+
+WASM_API_EXTERN bool wasm_instance_hibernate(wasm_instance_t*, const char* path);
+WASM_API_EXTERN bool wasm_instance_resume(wasm_instance_t*, const char* path);
+
+
+// Instance Pools
+
+WASM_DECLARE_OWN(instance_pool)
+
+WASM_API_EXTERN own wasm_instance_pool_t* wasm_instance_pool_new(
+  wasm_store_t*, const wasm_module_t*, const wasm_extern_vec_t* imports,
+  size_t capacity, own wasm_trap_t**
+);
+
+WASM_API_EXTERN own wasm_instance_t* wasm_instance_pool_acquire(
+  wasm_instance_pool_t*, own wasm_trap_t**);
+WASM_API_EXTERN void wasm_instance_pool_release(
+  wasm_instance_pool_t*, own wasm_instance_t*);
+WASM_API_EXTERN size_t wasm_instance_pool_size(const wasm_instance_pool_t*);
+
+WASM_API_EXTERN size_t wasm_instance_pool_hits(const wasm_instance_pool_t*);
+WASM_API_EXTERN size_t wasm_instance_pool_misses(const wasm_instance_pool_t*);
+WASM_API_EXTERN size_t wasm_instance_pool_resets(const wasm_instance_pool_t*);
+WASM_API_EXTERN uint64_t wasm_instance_pool_reset_nanoseconds(const wasm_instance_pool_t*);
+
+
+// Linkers
+
+WASM_DECLARE_OWN(linker)
+
+WASM_API_EXTERN own wasm_linker_t* wasm_linker_new(wasm_store_t*, const wasm_module_t*);
+
+WASM_API_EXTERN bool wasm_linker_define(
+  wasm_linker_t*, const wasm_name_t* module, const wasm_name_t* name,
+  const wasm_extern_t*);
+WASM_API_EXTERN own wasm_instance_t* wasm_linker_instantiate(
+  wasm_linker_t*, own wasm_trap_t**);
 
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -204,6 +204,45 @@ template<class T> own<T> make_own(T* ptr) {
 
 // Configuration
 
+// Allocators for the array buffers of each store. Wasm memories are
+// allocated by the engine itself, but are advised to use transparent huge
+// pages under the HUGE_PAGE allocator as well.
+
+enum class AllocatorKind : uint8_t {
+  DEFAULT,
+  HUGE_PAGE,  // large buffers backed by huge pages
+  ARENA,  // freed buffers are recycled within the store
+  CUSTOM,
+};
+
+struct AllocatorCallbacks {
+  using allocate_type = auto (*)(void* env, size_t size) -> void*;  // zeroed
+  using free_type = void (*)(void* env, void* data, size_t size);
+
+  void* env;
+  allocate_type allocate;
+  free_type free;
+};
+
+struct AllocatorStats {
+  size_t allocations;
+  size_t frees;
+  size_t reuses;  // allocations served by the arena
+  size_t live_bytes;
+  size_t peak_bytes;
+  size_t huge_page_bytes;  // buffers mapped with explicit huge pages
+  size_t advised_huge_page_bytes;  // advised to use transparent huge pages
+};
+
+struct HandleStats {
+  size_t slabs;
+  size_t capacity;  // handles in all slabs
+  size_t live;
+  size_t high_water;  // peak of live
+  size_t slab_allocations;
+  size_t slab_releases;
+};
+
 class WASM_API_EXTERN Config {
   friend class destroyer;
   void destroy();
@@ -215,6 +254,11 @@ protected:
 public:
   static auto make() -> own<Config>;
 
+  // CUSTOM without callbacks, or callbacks missing a function, select
+  // DEFAULT instead.
+  void set_allocator(AllocatorKind);
+  void set_allocator(const AllocatorCallbacks&);  // also sets CUSTOM
+
   // Implementations may provide custom methods for manipulating Configs.
 };
 
@@ -236,6 +280,21 @@ public:
 
 // Store
 
+struct HeapStats {
+  size_t used_bytes;
+  size_t total_bytes;
+  size_t limit_bytes;
+  size_t external_bytes;  // array buffers and memories
+  size_t code_bytes;  // JS code and metadata, Wasm code is not on the heap
+};
+
+enum class MemoryPressure : uint8_t { NONE, MODERATE, CRITICAL };
+
+enum class CollectionKind : uint8_t {
+  MINOR,  // young generation only
+  FULL,
+};
+
 class WASM_API_EXTERN Store {
   friend class destroyer;
   void destroy();
@@ -246,6 +305,34 @@ protected:
 
 public:
   static auto make(Engine*) -> own<Store>;
+
+  // Changes whenever the data of a memory with outstanding views moved or
+  // changed size.
+  auto memory_generation() const -> uint64_t;
+
+  auto allocator_stats() const -> AllocatorStats;
+
+  // Usage of the slab arena backing references.
+  auto handle_stats() const -> HandleStats;
+
+  // Import and export names created so far. They are created once per
+  // module and freed with it, so instantiating a module again adds none.
+  auto names_created() const -> size_t;
+
+  // Garbage collection control, for embedders that schedule it themselves.
+  // The store is expected to be idle for the next budget_ms milliseconds;
+  // returns true if no further idle time is needed for now.
+  auto heap_stats() const -> HeapStats;
+  void notify_memory_pressure(MemoryPressure);
+  auto idle_notification(uint32_t budget_ms) -> bool;
+  void collect(CollectionKind);
+
+  // When deferred, finalizers of host info whose reference was collected,
+  // including those of functions, are queued instead of run during garbage
+  // collection. Running them returns the number still pending; the store
+  // runs the rest when it is destroyed.
+  void set_deferred_finalizers(bool);
+  auto run_pending_finalizers(size_t budget = SIZE_MAX) -> size_t;
 };
 
 
@@ -402,10 +489,14 @@ protected:
   ~MemoryType() = default;
 
 public:
-  static auto make(Limits) -> own<MemoryType>;
+  // Limits are in pages for 32- and 64-bit memories alike.
+  static auto make(Limits, bool shared = false, bool is64 = false)
+    -> own<MemoryType>;
   auto copy() const -> own<MemoryType>;
 
   auto limits() const -> const Limits&;
+  auto shared() const -> bool;
+  auto is64() const -> bool;
 };
 
 
@@ -636,6 +727,18 @@ public:
 
 template<class T> class WASM_API_EXTERN Shared;
 
+// Views into a module's binary, valid as long as the module is alive.
+
+struct ByteSpan {
+  const byte_t* data;
+  size_t size;
+};
+
+struct CustomSection {
+  ByteSpan name;
+  ByteSpan data;
+};
+
 class WASM_API_EXTERN Module : public Ref {
   friend class destroyer;
   void destroy();
@@ -652,6 +755,9 @@ public:
   auto imports() const -> ownvec<ImportType>;
   auto exports() const -> ownvec<ExportType>;
 
+  auto custom_sections() const -> vec<CustomSection>;
+  auto func_name(uint32_t index) const -> ByteSpan;  // null data if unnamed
+
   auto share() const -> own<Shared<Module>>;
   static auto obtain(Store*, const Shared<Module>*) -> own<Module>;
 
@@ -766,6 +872,19 @@ protected:
   auto type() const -> own<GlobalType>;
   auto get() const -> Val;
   void set(const Val&);
+
+  // Typed accessors must match the content type. The raw address of a
+  // numeric global, null otherwise, is valid for the global's lifetime.
+  // Accesses through it are plain, like those of Wasm code.
+  auto get_i32() const -> int32_t;
+  auto get_i64() const -> int64_t;
+  auto get_f32() const -> float32_t;
+  auto get_f64() const -> float64_t;
+  void set_i32(int32_t);
+  void set_i64(int64_t);
+  void set_f32(float32_t);
+  void set_f64(float64_t);
+  auto raw_address() const -> void*;
 };
 
 
@@ -791,11 +910,55 @@ public:
   auto set(size_t index, const Ref*) -> bool;
   auto size() const -> size_t;
   auto grow(size_t delta, const Ref* init = nullptr) -> bool;
+
+  // Bulk operations fail without effect if a range is out of bounds or a
+  // reference does not match the element type. Null refs clear entries.
+  // Both tables of copy_from must belong to the same store.
+  auto get_range(size_t start, size_t n) const -> ownvec<Ref>;
+  auto set_range(size_t start, const Ref* const refs[], size_t n) -> bool;
+  auto fill(size_t start, size_t n, const Ref*) -> bool;
+  auto copy_from(size_t dst, const Table* src, size_t src_start, size_t n)
+    -> bool;
+
+  // Calls the function at an index, trapping if the entry is null or its
+  // signature does not match the arguments and number of results.
+  auto call(size_t index, const vec<Val>& args, vec<Val>& results) const
+    -> own<Trap>;
 };
 
 
 // Memory Instances
 
+// Cached pointer to a memory's data. It stays valid while the generation
+// equals the store's memory generation. The store checks for changes
+// whenever Wasm code returns or calls out, and when a memory is grown.
+
+struct MemoryView {
+  byte_t* base;
+  size_t size;
+  uint64_t generation;
+};
+
+// A file range mapped over part of a memory. Offsets and size must be
+// multiples of the host page size. Shared mappings write through to the
+// file, which must then be open for writing; private ones copy on write.
+
+struct MemoryMapping {
+  int fd;
+  uint64_t file_offset;
+  size_t offset;
+  size_t size;
+  bool shared;
+};
+
+// A host buffer and the memory range it is read from or written to.
+
+struct MemoryIovec {
+  size_t offset;
+  byte_t* data;
+  size_t size;
+};
+
 class WASM_API_EXTERN Memory : public Extern {
   friend class destroyer;
   void destroy();
@@ -806,6 +969,8 @@ protected:
 
 public:
   static auto make(Store*, const MemoryType*) -> own<Memory>;
+  static auto make(Store*, const MemoryType*, const MemoryMapping&)
+    -> own<Memory>;
   auto copy() const -> own<Memory>;
 
   using pages_t = uint32_t;
@@ -817,11 +982,61 @@ public:
   auto data_size() const -> size_t;
   auto size() const -> pages_t;
   auto grow(pages_t delta) -> bool;
+
+  auto view() const -> MemoryView;
+
+  // Replaces the contents of a range with a file mapping. Only supported on
+  // Linux. The mapping is lost, but not its contents, if the memory ever
+  // moves when growing.
+  auto map(const MemoryMapping&) -> bool;
+
+  // Releases a range to the system; it reads as zeros afterwards, also
+  // where a file was mapped, which the range no longer reflects. Discarded
+  // pages count as dirty. Offset and size must be multiples of
+  // dirty_page_size().
+  auto discard(size_t offset, size_t size) -> bool;
+
+  // Dirty page tracking. A checkpoint starts a new epoch, returned, or 0 on
+  // failure. dirty_pages has one bit per host page written since the epoch
+  // began, and is invalid unless the epoch is the memory's latest.
+  static auto dirty_page_size() -> size_t;
+  auto checkpoint() -> uint64_t;
+  auto dirty_pages(uint64_t since_epoch) const -> vec<byte_t>;
+
+  // Bounds-checked bulk access. Each call fails without effect if any of
+  // its ranges is out of bounds. Both memories of copy_from must belong to
+  // the same store.
+  auto read(size_t offset, byte_t* out, size_t size) const -> bool;
+  auto write(size_t offset, const byte_t* data, size_t size) -> bool;
+  auto fill(size_t offset, byte_t value, size_t size) -> bool;
+  auto copy_within(size_t dst, size_t src, size_t size) -> bool;
+  auto copy_from(
+    size_t dst, const Memory* src, size_t src_offset, size_t size
+  ) -> bool;
+  auto readv(const MemoryIovec[], size_t n) const -> bool;
+  auto writev(const MemoryIovec[], size_t n) -> bool;
+
+  // Only shared memories can be shared. The memory obtained in another
+  // store, possibly on another thread, aliases the same backing store.
+  auto share() const -> own<Shared<Memory>>;
+  static auto obtain(Store*, const Shared<Memory>*) -> own<Memory>;
+};
+
+template<>
+class WASM_API_EXTERN Shared<Memory> {
+  friend class destroyer;
+  void destroy();
+
+protected:
+  Shared() = default;
+  ~Shared() = default;
 };
 
 
 // Module Instances
 
+class Snapshot;
+
 class WASM_API_EXTERN Instance : public Ref {
   friend class destroyer;
   void destroy();
@@ -834,9 +1049,98 @@ public:
   static auto make(
     Store*, const Module*, const vec<Extern*>&, own<Trap>* = nullptr
   ) -> own<Instance>;
+  // Instantiates n times, with imports[i] for instance i. Consecutive
+  // instances given identical import lists share one import object.
+  static auto make_many(
+    Store*, const Module*, const vec<Extern*> imports[], size_t n,
+    own<Trap>* = nullptr
+  ) -> ownvec<Instance>;
   auto copy() const -> own<Instance>;
 
   auto exports() const -> ownvec<Extern>;
+
+  // Null if absent. Indices follow the order of Module::exports().
+  auto export_by_name(const Name&) const -> own<Extern>;
+  auto export_by_index(size_t index) const -> own<Extern>;
+
+  // Snapshots capture the instance's own memory, mutable numeric globals
+  // and tables. Instances made from a snapshot skip the start function and
+  // should be given the same imports; they must be made in the snapshot's
+  // store, otherwise null is returned.
+  auto snapshot() const -> own<Snapshot>;
+  static auto make_from_snapshot(
+    Store*, const Snapshot*, const vec<Extern*>&, own<Trap>* = nullptr
+  ) -> own<Instance>;
+
+  // Hibernation writes the non-zero pages of the instance's memory to a
+  // file and discards the memory. Resuming restores it from the file, on
+  // Linux lazily by mapping it. Globals and tables stay in place.
+  auto hibernate(const char* path) -> bool;
+  auto resume(const char* path) -> bool;
+};
+
+
+// Instance Snapshots
+
+class WASM_API_EXTERN Snapshot {
+  friend class destroyer;
+  void destroy();
+
+protected:
+  Snapshot() = default;
+  ~Snapshot() = default;
+
+public:
+  auto memory_size() const -> size_t;
+};
+
+
+// Instance Pools
+
+class WASM_API_EXTERN InstancePool {
+  friend class destroyer;
+  void destroy();
+
+protected:
+  InstancePool() = default;
+  ~InstancePool() = default;
+
+public:
+  // Instantiates the module once, runs its start function, and resets
+  // released instances to the state right after that. Fails for modules
+  // defining mutable globals of reference type, which cannot be reset.
+  static auto make(
+    Store*, const Module*, const vec<Extern*>&, size_t capacity,
+    own<Trap>* = nullptr
+  ) -> own<InstancePool>;
+
+  auto acquire(own<Trap>* = nullptr) -> own<Instance>;
+  void release(own<Instance>&&);  // drops instances that cannot be reused
+  auto size() const -> size_t;  // idle instances
+
+  auto hits() const -> size_t;  // acquisitions served from the pool
+  auto misses() const -> size_t;  // acquisitions that had to instantiate
+  auto resets() const -> size_t;
+  auto reset_nanoseconds() const -> uint64_t;  // total time spent resetting
+};
+
+
+// Linkers
+
+class WASM_API_EXTERN Linker {
+  friend class destroyer;
+  void destroy();
+
+protected:
+  Linker() = default;
+  ~Linker() = default;
+
+public:
+  static auto make(Store*, const Module*) -> own<Linker>;
+
+  // Fails if the module has no such import or its type does not match.
+  auto define(const Name& module, const Name& name, const Extern*) -> bool;
+  auto instantiate(own<Trap>* = nullptr) -> own<Instance>;
 };
 
 
@@ -1,7 +1,23 @@
 #include "wasm-bin.hh"
 
+#include <algorithm>
 #include <cstring>
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define WASM_BIN_AVX2
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define WASM_BIN_SSE2
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
 namespace wasm {
 namespace bin {
 
@@ -162,43 +178,127 @@ auto wrapper(const GlobalType* type) -> vec<byte_t> {
 // Numbers
 
 auto u32(const byte_t*& pos) -> uint32_t {
-  uint32_t n = 0;
-  uint32_t shift = 0;
-  byte_t b;
+  uint32_t b = static_cast<uint8_t>(*pos++);
+  if (b < 0x80) return b;
+  uint32_t n = b & 0x7f;
+  uint32_t shift = 7;
   do {
-    b = *pos++;
-    n += (b & 0x7f) << shift;
+    b = static_cast<uint8_t>(*pos++);
+    n |= (b & 0x7f) << shift;
     shift += 7;
   } while ((b & 0x80) != 0);
   return n;
 }
 
 auto u64(const byte_t*& pos) -> uint64_t {
-  uint64_t n = 0;
-  uint64_t shift = 0;
-  byte_t b;
+  uint64_t b = static_cast<uint8_t>(*pos++);
+  if (b < 0x80) return b;
+  uint64_t n = b & 0x7f;
+  uint64_t shift = 7;
   do {
-    b = *pos++;
-    n += (b & 0x7f) << shift;
+    b = static_cast<uint8_t>(*pos++);
+    n |= (b & 0x7f) << shift;
     shift += 7;
   } while ((b & 0x80) != 0);
   return n;
 }
 
 void u32_skip(const byte_t*& pos) {
-  bin::u32(pos);
+  while ((*pos++ & 0x80) != 0) {}
+}
+
+
+// Runs of numbers
+
+#if defined(WASM_BIN_AVX2) || defined(WASM_BIN_SSE2)
+inline auto ctz(uint32_t mask) -> uint32_t {
+#if defined(_MSC_VER) && !defined(__clang__)
+  unsigned long i;
+  _BitScanForward(&i, mask);
+  return i;
+#else
+  return __builtin_ctz(mask);
+#endif
+}
+#endif
+
+#if defined(WASM_BIN_AVX2) || defined(WASM_BIN_SSE2)
+// Decodes scalars until the block containing pos is consumed.
+inline void u32s_scalar(
+  const byte_t*& pos, const byte_t* stop, uint32_t* out, size_t& i, size_t n
+) {
+  while (pos < stop && i < n) out[i++] = bin::u32(pos);
+}
+#endif
+
+// Most numbers in a run are indices below 128 and hence encoded in a single
+// byte. The vector paths test a whole block for continuation bits at once,
+// zero-extend its leading single-byte numbers into the output, and decode
+// the multi-byte number following them as a scalar. A block that starts
+// with a multi-byte number is decoded as scalars entirely, so that runs of
+// mostly multi-byte numbers pay for at most one vector test per block and
+// are not slower than scalar decoding.
+void u32s(const byte_t*& pos, const byte_t* end, uint32_t* out, size_t n) {
+  size_t i = 0;
+#ifdef WASM_BIN_AVX2
+  while (n - i >= 32 && end - pos >= 32) {
+    auto block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pos));
+    uint32_t mask = _mm256_movemask_epi8(block);
+    if (mask & 1) {
+      bin::u32s_scalar(pos, pos + 32, out, i, n);
+      continue;
+    }
+    // Only the parts holding leading single-byte numbers are widened.
+    auto singles = mask == 0 ? 32 : bin::ctz(mask);
+    for (uint32_t k = 0; 8 * k < singles; ++k) {
+      auto part = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(pos + 8 * k));
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i + 8 * k),
+        _mm256_cvtepu8_epi32(part));
+    }
+    pos += singles;
+    i += singles;
+    if (mask != 0) out[i++] = bin::u32(pos);
+  }
+#endif
+#ifdef WASM_BIN_SSE2
+  auto zero = _mm_setzero_si128();
+  while (n - i >= 16 && end - pos >= 16) {
+    auto block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pos));
+    uint32_t mask = _mm_movemask_epi8(block);
+    if (mask & 1) {
+      bin::u32s_scalar(pos, pos + 16, out, i, n);
+      continue;
+    }
+    auto lo = _mm_unpacklo_epi8(block, zero);
+    auto hi = _mm_unpackhi_epi8(block, zero);
+    auto dst = reinterpret_cast<__m128i*>(out + i);
+    _mm_storeu_si128(dst + 0, _mm_unpacklo_epi16(lo, zero));
+    _mm_storeu_si128(dst + 1, _mm_unpackhi_epi16(lo, zero));
+    _mm_storeu_si128(dst + 2, _mm_unpacklo_epi16(hi, zero));
+    _mm_storeu_si128(dst + 3, _mm_unpackhi_epi16(hi, zero));
+    if (mask == 0) {
+      pos += 16;
+      i += 16;
+    } else {
+      auto singles = bin::ctz(mask);
+      pos += singles;
+      i += singles;
+      out[i++] = bin::u32(pos);
+    }
+  }
+#endif
+  for (; i < n; ++i) out[i] = bin::u32(pos);
 }
 
 
 // Names
 
-auto name(const byte_t*& pos) -> Name {
-  auto size = bin::u32(pos);
-  auto start = pos;
-  auto name = Name::make_uninitialized(size);
-  std::memcpy(name.get(), start, size);
-  pos += size;
-  return name;
+auto name_span(const byte_t*& pos) -> Span {
+  Span span;
+  span.size = bin::u32(pos);
+  span.data = pos;
+  pos += span.size;
+  return span;
 }
 
 void name_skip(const byte_t*& pos) {
@@ -209,14 +309,14 @@ void name_skip(const byte_t*& pos) {
 
 // Types
 
-auto valtype(const byte_t*& pos) -> own<wasm::ValType> {
+auto valkind(const byte_t*& pos) -> ValKind {
   switch (*pos++) {
-    case 0x7f: return ValType::make(ValKind::I32);
-    case 0x7e: return ValType::make(ValKind::I64);
-    case 0x7d: return ValType::make(ValKind::F32);
-    case 0x7c: return ValType::make(ValKind::F64);
-    case 0x70: return ValType::make(ValKind::FUNCREF);
-    case 0x6f: return ValType::make(ValKind::EXTERNREF);
+    case 0x7f: return ValKind::I32;
+    case 0x7e: return ValKind::I64;
+    case 0x7d: return ValKind::F32;
+    case 0x7c: return ValKind::F64;
+    case 0x70: return ValKind::FUNCREF;
+    case 0x6f: return ValKind::EXTERNREF;
     default:
       // TODO(wasm+): support new value types
       assert(false);
@@ -227,77 +327,63 @@ auto mutability(const byte_t*& pos) -> Mutability {
   return *pos++ ? Mutability::VAR : Mutability::CONST;
 }
 
+// 64-bit limits saturate, no engine supports that many pages anyway.
+auto limit64(const byte_t*& pos) -> uint32_t {
+  auto n = bin::u64(pos);
+  return n > Limits(0).max ? Limits(0).max : static_cast<uint32_t>(n);
+}
+
 auto limits(const byte_t*& pos) -> Limits {
   auto tag = *pos++;
-  auto min = bin::u32(pos);
+  auto is64 = (tag & 0x04) != 0;
+  auto min = is64 ? bin::limit64(pos) : bin::u32(pos);
   if ((tag & 0x01) == 0) {
     return Limits(min);
   } else {
-    auto max = bin::u32(pos);
+    auto max = is64 ? bin::limit64(pos) : bin::u32(pos);
     return Limits(min, max);
   }
 }
 
-auto stacktype(const byte_t*& pos) -> ownvec<ValType> {
-  size_t size = bin::u32(pos);
-  auto v = ownvec<ValType>::make_uninitialized(size);
-  for (uint32_t i = 0; i < size; ++i) v[i] = bin::valtype(pos);
-  return v;
-}
-
-auto functype(const byte_t*& pos) -> own<FuncType> {
+auto functype(const byte_t*& pos, ModuleInfo& info) -> SigInfo {
   assert(*pos == 0x60);
   ++pos;
-  auto params = bin::stacktype(pos);
-  auto results = bin::stacktype(pos);
-  return FuncType::make(std::move(params), std::move(results));
-}
-
-auto globaltype(const byte_t*& pos) -> own<GlobalType> {
-  auto content = bin::valtype(pos);
-  auto mutability = bin::mutability(pos);
-  return GlobalType::make(std::move(content), mutability);
-}
-
-auto tabletype(const byte_t*& pos) -> own<TableType> {
-  auto elem = bin::valtype(pos);
-  auto limits = bin::limits(pos);
-  return TableType::make(std::move(elem), limits);
-}
-
-auto memorytype(const byte_t*& pos) -> own<MemoryType> {
-  auto limits = bin::limits(pos);
-  return MemoryType::make(limits);
-}
-
-
-void mutability_skip(const byte_t*& pos) {
-  ++pos;
-}
-
-void limits_skip(const byte_t*& pos) {
-  auto tag = *pos++;
-  bin::u32_skip(pos);
-  if ((tag & 0x01) != 0) bin::u32_skip(pos);
-}
-
-void valtype_skip(const byte_t*& pos) {
-  // TODO(wasm+): support new value types
-  ++pos;
+  SigInfo sig;
+  sig.offset = static_cast<uint32_t>(info.valkinds.size());
+  sig.params = bin::u32(pos);
+  for (uint32_t i = 0; i < sig.params; ++i) {
+    info.valkinds.push_back(bin::valkind(pos));
+  }
+  sig.results = bin::u32(pos);
+  for (uint32_t i = 0; i < sig.results; ++i) {
+    info.valkinds.push_back(bin::valkind(pos));
+  }
+  return sig;
 }
 
-void globaltype_skip(const byte_t*& pos) {
-  bin::valtype_skip(pos);
-  bin::mutability_skip(pos);
+auto globaltype(const byte_t*& pos) -> ExternInfo {
+  ExternInfo type;
+  type.kind = ExternKind::GLOBAL;
+  type.content = bin::valkind(pos);
+  type.mutability = bin::mutability(pos);
+  return type;
 }
 
-void tabletype_skip(const byte_t*& pos) {
-  bin::valtype_skip(pos);
-  bin::limits_skip(pos);
+auto tabletype(const byte_t*& pos) -> ExternInfo {
+  ExternInfo type;
+  type.kind = ExternKind::TABLE;
+  type.content = bin::valkind(pos);
+  type.limits = bin::limits(pos);
+  return type;
 }
 
-void memorytype_skip(const byte_t*& pos) {
-  bin::limits_skip(pos);
+auto memorytype(const byte_t*& pos) -> ExternInfo {
+  ExternInfo type;
+  type.kind = ExternKind::MEMORY;
+  type.shared = (*pos & 0x02) != 0;
+  type.is64 = (*pos & 0x04) != 0;
+  type.limits = bin::limits(pos);
+  return type;
 }
 
 
@@ -318,6 +404,7 @@ void expr_skip(const byte_t*& pos) {
       pos += 8;
     } break;
     case 0xd0: {  // ref.null
+      ++pos;  // heap type
     } break;
     default: {
       assert(false);
@@ -329,241 +416,541 @@ void expr_skip(const byte_t*& pos) {
 
 // Sections
 
-enum sec_t : byte_t {
-  SEC_TYPE = 1,
-  SEC_IMPORT = 2,
-  SEC_FUNC = 3,
-  SEC_TABLE = 4,
-  SEC_MEMORY = 5,
-  SEC_GLOBAL = 6,
-  SEC_EXPORT = 7
-};
-
-auto section(const vec<byte_t>& binary, bin::sec_t sec) -> const byte_t* {
+auto section_index(const vec<byte_t>& binary) -> SectionIndex {
+  SectionIndex index;
+  index.binary = binary.get();
+  for (auto& section : index.sections) section = Span{nullptr, 0};
   const byte_t* end = binary.get() + binary.size();
   const byte_t* pos = binary.get() + 8;  // skip header
-  while (pos < end && *pos++ != sec) {
-    auto size = bin::u32(pos);
-    pos += size;
+  while (pos < end) {
+    auto id = static_cast<uint8_t>(*pos++);
+    Span payload;
+    payload.size = bin::u32(pos);
+    payload.data = pos;
+    pos += payload.size;
+    if (id == SEC_CUSTOM) {
+      auto start = payload.data;
+      auto name = bin::name_span(start);
+      auto size = payload.size - (start - payload.data);
+      index.customs.push_back(CustomSection{name, Span{start, size}});
+    } else if (id < SEC_COUNT) {
+      index.sections[id] = payload;
+    }
   }
-  if (pos == end) return nullptr;
-  bin::u32_skip(pos);
-  return pos;
+  return index;
 }
 
-auto section_end(const vec<byte_t>& binary, bin::sec_t sec) -> const byte_t* {
+
+// Copy of the binary with all sections of the given id removed.
+auto strip_section(const vec<byte_t>& binary, sec_t sec) -> vec<byte_t> {
+  auto result = vec<byte_t>::make_uninitialized(binary.size());
+  auto out = result.get();
   const byte_t* end = binary.get() + binary.size();
   const byte_t* pos = binary.get() + 8;  // skip header
-  while (pos < end && *pos != sec) {
-    ++pos;
+  std::memcpy(out, binary.get(), 8);
+  out += 8;
+  while (pos < end) {
+    auto start = pos;
+    auto id = static_cast<uint8_t>(*pos++);
     auto size = bin::u32(pos);
     pos += size;
+    if (id == sec) continue;
+    std::memcpy(out, start, pos - start);
+    out += pos - start;
   }
-  if (pos == end) return nullptr;
-  ++pos;
-  auto size = bin::u32(pos);
-  return pos + size;
+  auto stripped = vec<byte_t>::make_uninitialized(out - result.get());
+  std::memcpy(stripped.get(), result.get(), stripped.size());
+  return stripped;
+}
+
+// Skips a data segment up to its contents; returns whether it is active.
+auto data_segment_prefix(const byte_t*& pos) -> bool {
+  auto flags = bin::u32(pos);
+  if (flags == 1) return false;
+  if (flags == 2) bin::u32_skip(pos);  // memory index
+  expr_skip(pos);
+  return true;
+}
+
+// Skips an element segment up to its contents; returns whether it is
+// active on a table from first_table on.
+auto elem_segment_prefix(
+  const byte_t*& pos, uint32_t first_table, bool* exprs
+) -> bool {
+  auto flags = bin::u32(pos);
+  *exprs = (flags & 4) != 0;
+  auto active = (flags & 1) == 0;
+  uint32_t table = 0;
+  if (active) {
+    if (flags & 2) table = bin::u32(pos);
+    expr_skip(pos);
+  }
+  if (flags & 3) ++pos;  // element kind or reference type
+  return active && table >= first_table;
+}
+
+// Active segments are applied at instantiation and dropped right after.
+// Emptying them keeps the module valid and its segment indices intact,
+// while instantiation no longer copies their contents; data segments only
+// if data is set, element segments only of tables from first_table on.
+auto empty_active_segments(
+  const vec<byte_t>& binary, bool data, uint32_t first_table
+) -> vec<byte_t> {
+  // Section sizes are re-encoded in 5 bytes, for the two sections touched.
+  auto result = vec<byte_t>::make_uninitialized(binary.size() + 2 * 5);
+  auto out = result.get();
+  const byte_t* end = binary.get() + binary.size();
+  const byte_t* pos = binary.get() + 8;  // skip header
+  std::memcpy(out, binary.get(), 8);
+  out += 8;
+  while (pos < end) {
+    auto start = pos;
+    auto id = static_cast<uint8_t>(*pos++);
+    auto size = bin::u32(pos);
+    auto payload = pos;
+    pos += size;
+    if (id != SEC_ELEM && (id != SEC_DATA || !data)) {
+      std::memcpy(out, start, pos - start);
+      out += pos - start;
+      continue;
+    }
+    *out++ = id;
+    auto size_out = out;
+    out += 5;
+    auto n = bin::u32(payload);
+    encode_u32(out, n);
+    for (uint32_t i = 0; i < n; ++i) {
+      auto segment = payload;
+      auto exprs = false;
+      auto active = id == SEC_DATA
+        ? data_segment_prefix(payload)
+        : elem_segment_prefix(payload, first_table, &exprs);
+      auto prefix_end = payload;
+      auto count = bin::u32(payload);
+      if (id == SEC_DATA) {
+        payload += count;
+      } else {
+        for (uint32_t j = 0; j < count; ++j) {
+          if (exprs) expr_skip(payload); else bin::u32_skip(payload);
+        }
+      }
+      if (active) {
+        std::memcpy(out, segment, prefix_end - segment);
+        out += prefix_end - segment;
+        *out++ = 0;
+      } else {
+        std::memcpy(out, segment, payload - segment);
+        out += payload - segment;
+      }
+    }
+    assert(payload == pos);
+    encode_size32(size_out, out - size_out - 5);
+  }
+  auto emptied = vec<byte_t>::make_uninitialized(out - result.get());
+  std::memcpy(emptied.get(), result.get(), emptied.size());
+  return emptied;
 }
 
 
 // Type section
 
-auto types(const vec<byte_t>& binary) -> ownvec<FuncType> {
-  auto pos = bin::section(binary, SEC_TYPE);
-  if (pos == nullptr) return ownvec<FuncType>::make();
+void types(const SectionIndex& index, ModuleInfo& info) {
+  auto pos = index.section(SEC_TYPE);
+  if (pos == nullptr) return;
   size_t size = bin::u32(pos);
   // TODO(wasm+): support new deftypes
-  auto v = ownvec<FuncType>::make_uninitialized(size);
+  info.sigs.reserve(size);
   for (uint32_t i = 0; i < size; ++i) {
-    v[i] = bin::functype(pos);
+    info.sigs.push_back(bin::functype(pos, info));
   }
-  assert(pos = bin::section_end(binary, SEC_TYPE));
-  return v;
+  assert(pos == index.section_end(SEC_TYPE));
 }
 
 
 // Import section
 
-auto imports(
-  const vec<byte_t>& binary, const ownvec<FuncType>& types
-) -> ownvec<ImportType> {
-  auto pos = bin::section(binary, SEC_IMPORT);
-  if (pos == nullptr) return ownvec<ImportType>::make();
+void imports(const SectionIndex& index, ModuleInfo& info) {
+  auto pos = index.section(SEC_IMPORT);
+  if (pos == nullptr) return;
   size_t size = bin::u32(pos);
-  auto v = ownvec<ImportType>::make_uninitialized(size);
+  info.imports.resize(size);
   for (uint32_t i = 0; i < size; ++i) {
-    auto module = bin::name(pos);
-    auto name = bin::name(pos);
-    own<ExternType> type;
+    auto& import = info.imports[i];
+    import.module = bin::name_span(pos);
+    import.name = bin::name_span(pos);
     switch (*pos++) {
-      case 0x00: type = types[bin::u32(pos)]->copy(); break;
-      case 0x01: type = bin::tabletype(pos); break;
-      case 0x02: type = bin::memorytype(pos); break;
-      case 0x03: type = bin::globaltype(pos); break;
+      case 0x00: {
+        import.type.kind = ExternKind::FUNC;
+        import.type.sig = bin::u32(pos);
+      } break;
+      case 0x01: import.type = bin::tabletype(pos); break;
+      case 0x02: import.type = bin::memorytype(pos); break;
+      case 0x03: import.type = bin::globaltype(pos); break;
       default: assert(false);
     }
-    v[i] = ImportType::make(
-      std::move(module), std::move(name), std::move(type));
   }
-  assert(pos = bin::section_end(binary, SEC_IMPORT));
-  return v;
+  assert(pos == index.section_end(SEC_IMPORT));
 }
 
-auto count(const ownvec<ImportType>& imports, ExternKind kind) -> uint32_t {
+auto count(const ModuleInfo& info, ExternKind kind) -> uint32_t {
   uint32_t n = 0;
-  for (uint32_t i = 0; i < imports.size(); ++i) {
-    if (imports[i]->type()->kind() == kind) ++n;
+  for (auto& import : info.imports) {
+    if (import.type.kind == kind) ++n;
   }
   return n;
 }
 
+// Imported entities come first in each index space.
+void imported(
+  const ModuleInfo& info, ExternKind kind, std::vector<ExternInfo>& v
+) {
+  for (auto& import : info.imports) {
+    if (import.type.kind == kind) v.push_back(import.type);
+  }
+}
+
 
 // Function section
 
-auto funcs(
-  const vec<byte_t>& binary,
-  const ownvec<ImportType>& imports, const ownvec<FuncType>& types
-) -> ownvec<FuncType> {
-  auto pos = bin::section(binary, SEC_FUNC);
+void funcs(
+  const SectionIndex& index, const ModuleInfo& info,
+  std::vector<uint32_t>& v
+) {
+  auto pos = index.section(SEC_FUNC);
   size_t size = pos != nullptr ? bin::u32(pos) : 0;
-  auto v = ownvec<FuncType>::make_uninitialized(
-    size + count(imports, ExternKind::FUNC));
-  size_t j = 0;
-  for (uint32_t i = 0; i < imports.size(); ++i) {
-    auto et = imports[i]->type();
-    if (et->kind() == ExternKind::FUNC) {
-      v[j++] = et->func()->copy();
-    }
+  size_t imported = count(info, ExternKind::FUNC);
+  v.reserve(imported + size);
+  for (auto& import : info.imports) {
+    if (import.type.kind == ExternKind::FUNC) v.push_back(import.type.sig);
   }
   if (pos != nullptr) {
-    for (; j < v.size(); ++j) {
-      v[j] = types[bin::u32(pos)]->copy();
-    }
-    assert(pos = bin::section_end(binary, SEC_FUNC));
+    v.resize(imported + size);
+    bin::u32s(pos, index.section_end(SEC_FUNC), v.data() + imported, size);
+    assert(pos == index.section_end(SEC_FUNC));
   }
-  return v;
 }
 
 
 // Global section
 
-auto globals(
-  const vec<byte_t>& binary, const ownvec<ImportType>& imports
-) -> ownvec<GlobalType> {
-  auto pos = bin::section(binary, SEC_GLOBAL);
+void globals(
+  const SectionIndex& index, const ModuleInfo& info,
+  std::vector<ExternInfo>& v
+) {
+  auto pos = index.section(SEC_GLOBAL);
   size_t size = pos != nullptr ? bin::u32(pos) : 0;
-  auto v = ownvec<GlobalType>::make_uninitialized(
-    size + count(imports, ExternKind::GLOBAL));
-  size_t j = 0;
-  for (uint32_t i = 0; i < imports.size(); ++i) {
-    auto et = imports[i]->type();
-    if (et->kind() == ExternKind::GLOBAL) {
-      v[j++] = et->global()->copy();
-    }
-  }
+  v.reserve(size + count(info, ExternKind::GLOBAL));
+  imported(info, ExternKind::GLOBAL, v);
   if (pos != nullptr) {
-    for (; j < v.size(); ++j) {
-      v[j] = bin::globaltype(pos);
+    for (uint32_t i = 0; i < size; ++i) {
+      v.push_back(bin::globaltype(pos));
       expr_skip(pos);
     }
-    assert(pos = bin::section_end(binary, SEC_GLOBAL));
+    assert(pos == index.section_end(SEC_GLOBAL));
   }
-  return v;
+}
+
+auto mutable_ref_globals(const SectionIndex& index) -> bool {
+  auto pos = index.section(SEC_GLOBAL);
+  size_t size = pos != nullptr ? bin::u32(pos) : 0;
+  for (uint32_t i = 0; i < size; ++i) {
+    auto type = bin::globaltype(pos);
+    if (type.mutability == Mutability::VAR && is_ref(type.content)) {
+      return true;
+    }
+    expr_skip(pos);
+  }
+  return false;
 }
 
 
 // Table section
 
-auto tables(
-  const vec<byte_t>& binary, const ownvec<ImportType>& imports
-) -> ownvec<TableType> {
-  auto pos = bin::section(binary, SEC_TABLE);
+void tables(
+  const SectionIndex& index, const ModuleInfo& info,
+  std::vector<ExternInfo>& v
+) {
+  auto pos = index.section(SEC_TABLE);
   size_t size = pos != nullptr ? bin::u32(pos) : 0;
-  auto v = ownvec<TableType>::make_uninitialized(
-    size + count(imports, ExternKind::TABLE));
-  size_t j = 0;
-  for (uint32_t i = 0; i < imports.size(); ++i) {
-    auto et = imports[i]->type();
-    if (et->kind() == ExternKind::TABLE) {
-      v[j++] = et->table()->copy();
-    }
-  }
+  v.reserve(size + count(info, ExternKind::TABLE));
+  imported(info, ExternKind::TABLE, v);
   if (pos != nullptr) {
-    for (; j < v.size(); ++j) {
-      v[j] = bin::tabletype(pos);
+    for (uint32_t i = 0; i < size; ++i) {
+      v.push_back(bin::tabletype(pos));
     }
-    assert(pos = bin::section_end(binary, SEC_TABLE));
+    assert(pos == index.section_end(SEC_TABLE));
   }
-  return v;
 }
 
 
 // Memory section
 
-auto memories(
-  const vec<byte_t>& binary, const ownvec<ImportType>& imports
-) -> ownvec<MemoryType> {
-  auto pos = bin::section(binary, SEC_MEMORY);
+void memories(
+  const SectionIndex& index, const ModuleInfo& info,
+  std::vector<ExternInfo>& v
+) {
+  auto pos = index.section(SEC_MEMORY);
   size_t size = pos != nullptr ? bin::u32(pos) : 0;
-  auto v = ownvec<MemoryType>::make_uninitialized(
-    size + count(imports, ExternKind::MEMORY));
-  size_t j = 0;
-  for (uint32_t i = 0; i < imports.size(); ++i) {
-    auto et = imports[i]->type();
-    if (et->kind() == ExternKind::MEMORY) {
-      v[j++] = et->memory()->copy();
-    }
-  }
+  v.reserve(size + count(info, ExternKind::MEMORY));
+  imported(info, ExternKind::MEMORY, v);
   if (pos != nullptr) {
-    for (; j < v.size(); ++j) {
-      v[j] = bin::memorytype(pos);
+    for (uint32_t i = 0; i < size; ++i) {
+      v.push_back(bin::memorytype(pos));
     }
-    assert(pos = bin::section_end(binary, SEC_MEMORY));
+    assert(pos == index.section_end(SEC_MEMORY));
   }
-  return v;
 }
 
 
 // Export section
 
-auto exports(const vec<byte_t>& binary,
-  const ownvec<FuncType>& funcs, const ownvec<GlobalType>& globals,
-  const ownvec<TableType>& tables, const ownvec<MemoryType>& memories
-) -> ownvec<ExportType> {
-  auto pos = bin::section(binary, SEC_EXPORT);
-  if (pos == nullptr) return ownvec<ExportType>::make();
+void exports(const SectionIndex& index, ModuleInfo& info) {
+  auto pos = index.section(SEC_EXPORT);
+  if (pos == nullptr) return;
+  std::vector<uint32_t> funcs;
+  std::vector<ExternInfo> globals, tables, memories;
+  bin::funcs(index, info, funcs);
+  bin::globals(index, info, globals);
+  bin::tables(index, info, tables);
+  bin::memories(index, info, memories);
+
   size_t size = bin::u32(pos);
-  auto exports = ownvec<ExportType>::make_uninitialized(size);
+  info.exports.resize(size);
   for (uint32_t i = 0; i < size; ++i) {
-    auto name = bin::name(pos);
+    auto& export_ = info.exports[i];
+    export_.name = bin::name_span(pos);
     auto tag = *pos++;
-    auto index = bin::u32(pos);
-    own<ExternType> type;
+    export_.index = bin::u32(pos);
     switch (tag) {
-      case 0x00: type = funcs[index]->copy(); break;
-      case 0x01: type = tables[index]->copy(); break;
-      case 0x02: type = memories[index]->copy(); break;
-      case 0x03: type = globals[index]->copy(); break;
+      case 0x00: {
+        export_.type.kind = ExternKind::FUNC;
+        export_.type.sig = funcs[export_.index];
+      } break;
+      case 0x01: export_.type = tables[export_.index]; break;
+      case 0x02: export_.type = memories[export_.index]; break;
+      case 0x03: export_.type = globals[export_.index]; break;
       default: assert(false);
     }
-    exports[i] = ExportType::make(std::move(name), std::move(type));
   }
-  assert(pos = bin::section_end(binary, SEC_EXPORT));
-  return exports;
+  assert(pos == index.section_end(SEC_EXPORT));
 }
 
+
+// Name section
+
+// Custom sections are not validated by the engine, so the name section is
+// decoded with bounds checks, ignoring anything from a malformed entry on.
+
+auto u32(const byte_t*& pos, const byte_t* end, uint32_t& n) -> bool {
+  n = 0;
+  for (uint32_t shift = 0; shift < 35; shift += 7) {
+    if (pos == end) return false;
+    uint32_t b = static_cast<uint8_t>(*pos++);
+    n |= (b & 0x7f) << shift;
+    if ((b & 0x80) == 0) return true;
+  }
+  return false;
+}
+
+auto func_names(
+  const SectionIndex& index, const ModuleInfo& info
+) -> std::vector<Span> {
+  std::vector<Span> names;
+  const CustomSection* section = nullptr;
+  for (auto& custom : index.customs) {
+    if (custom.name.size == 4 && std::memcmp(custom.name.data, "name", 4) == 0) {
+      section = &custom;
+      break;
+    }
+  }
+  if (section == nullptr) return names;
+
+  size_t size = count(info, ExternKind::FUNC);
+  auto funcs = index.section(SEC_FUNC);
+  if (funcs != nullptr) size += bin::u32(funcs);
+  names.assign(size, Span{nullptr, 0});
+
+  auto pos = section->data.data;
+  auto end = pos + section->data.size;
+  while (pos < end) {
+    auto id = static_cast<uint8_t>(*pos++);
+    uint32_t sub_size;
+    if (!bin::u32(pos, end, sub_size) || sub_size > size_t(end - pos)) break;
+    auto sub_end = pos + sub_size;
+    if (id == 0x01) {  // function names
+      uint32_t n;
+      if (!bin::u32(pos, sub_end, n)) break;
+      for (uint32_t i = 0; i < n; ++i) {
+        uint32_t func_index, length;
+        if (!bin::u32(pos, sub_end, func_index) ||
+            !bin::u32(pos, sub_end, length) ||
+            length > size_t(sub_end - pos)) break;
+        if (func_index < size) names[func_index] = Span{pos, length};
+        pos += length;
+      }
+      break;
+    }
+    pos = sub_end;
+  }
+  return names;
+}
+
+
+// Export lookup
+
+auto less(const Span& a, const Span& b) -> bool {
+  auto size = std::min(a.size, b.size);
+  auto cmp = size == 0 ? 0 : std::memcmp(a.data, b.data, size);
+  return cmp < 0 || (cmp == 0 && a.size < b.size);
+}
+
+auto export_names(const ModuleInfo& info) -> std::vector<uint32_t> {
+  std::vector<uint32_t> names(info.exports.size());
+  for (uint32_t i = 0; i < names.size(); ++i) names[i] = i;
+  std::sort(names.begin(), names.end(), [&](uint32_t i, uint32_t j) {
+    return bin::less(info.exports[i].name, info.exports[j].name);
+  });
+  return names;
+}
+
+auto find_export(
+  const ModuleInfo& info, const std::vector<uint32_t>& names, const Span& name
+) -> size_t {
+  auto it = std::lower_bound(names.begin(), names.end(), name,
+    [&](uint32_t i, const Span& name) {
+      return bin::less(info.exports[i].name, name);
+    });
+  if (it == names.end() || bin::less(name, info.exports[*it].name)) {
+    return SIZE_MAX;
+  }
+  return *it;
+}
+
+
+// Modules
+
+auto module_info(const SectionIndex& index) -> ModuleInfo {
+  ModuleInfo info;
+  bin::types(index, info);
+  bin::imports(index, info);
+  bin::exports(index, info);
+  return info;
+}
+
+auto module_info(const vec<byte_t>& binary) -> ModuleInfo {
+  return bin::module_info(bin::section_index(binary));
+}
+
+
+// Materialization
+
+auto name(const Span& span) -> Name {
+  auto name = Name::make_uninitialized(span.size);
+  if (span.size > 0) std::memcpy(name.get(), span.data, span.size);
+  return name;
+}
+
+auto valtypes(const ValKind* kinds, size_t size) -> ownvec<ValType> {
+  auto v = ownvec<ValType>::make_uninitialized(size);
+  for (size_t i = 0; i < size; ++i) v[i] = ValType::make(kinds[i]);
+  return v;
+}
+
+auto externtype(
+  const ModuleInfo& info, const ExternInfo& type
+) -> own<ExternType> {
+  switch (type.kind) {
+    case ExternKind::FUNC: {
+      auto& sig = info.sigs[type.sig];
+      auto kinds = info.valkinds.data() + sig.offset;
+      return FuncType::make(
+        bin::valtypes(kinds, sig.params),
+        bin::valtypes(kinds + sig.params, sig.results));
+    }
+    case ExternKind::GLOBAL:
+      return GlobalType::make(ValType::make(type.content), type.mutability);
+    case ExternKind::TABLE:
+      return TableType::make(ValType::make(type.content), type.limits);
+    case ExternKind::MEMORY:
+      return MemoryType::make(type.limits, type.shared, type.is64);
+  }
+  return nullptr;
+}
+
+auto imports(const ModuleInfo& info) -> ownvec<ImportType> {
+  auto v = ownvec<ImportType>::make_uninitialized(info.imports.size());
+  for (size_t i = 0; i < v.size(); ++i) {
+    auto& import = info.imports[i];
+    v[i] = ImportType::make(bin::name(import.module), bin::name(import.name),
+      bin::externtype(info, import.type));
+  }
+  return v;
+}
+
+auto exports(const ModuleInfo& info) -> ownvec<ExportType> {
+  auto v = ownvec<ExportType>::make_uninitialized(info.exports.size());
+  for (size_t i = 0; i < v.size(); ++i) {
+    auto& export_ = info.exports[i];
+    v[i] = ExportType::make(bin::name(export_.name),
+      bin::externtype(info, export_.type));
+  }
+  return v;
+}
+
+// Import matching
+
+auto limits_match(const Limits& actual, const Limits& expected) -> bool {
+  return actual.min >= expected.min && actual.max <= expected.max;
+}
+
+auto matches(
+  const ModuleInfo& info, const ExternInfo& expected, const ExternType* actual
+) -> bool {
+  if (actual->kind() != expected.kind) return false;
+  switch (expected.kind) {
+    case ExternKind::FUNC: {
+      auto& sig = info.sigs[expected.sig];
+      auto kinds = info.valkinds.data() + sig.offset;
+      auto& params = actual->func()->params();
+      auto& results = actual->func()->results();
+      if (params.size() != sig.params || results.size() != sig.results) {
+        return false;
+      }
+      for (size_t i = 0; i < params.size(); ++i) {
+        if (params[i]->kind() != kinds[i]) return false;
+      }
+      for (size_t i = 0; i < results.size(); ++i) {
+        if (results[i]->kind() != kinds[sig.params + i]) return false;
+      }
+      return true;
+    }
+    case ExternKind::GLOBAL: {
+      auto global = actual->global();
+      return global->content()->kind() == expected.content &&
+        global->mutability() == expected.mutability;
+    }
+    case ExternKind::TABLE: {
+      auto table = actual->table();
+      return table->element()->kind() == expected.content &&
+        bin::limits_match(table->limits(), expected.limits);
+    }
+    case ExternKind::MEMORY: {
+      auto memory = actual->memory();
+      return memory->shared() == expected.shared &&
+        memory->is64() == expected.is64 &&
+        bin::limits_match(memory->limits(), expected.limits);
+    }
+  }
+  return false;
+}
+
+
 auto imports(const vec<byte_t>& binary) -> ownvec<ImportType> {
-  return bin::imports(binary, bin::types(binary));
+  return bin::imports(bin::module_info(binary));
 }
 
 auto exports(const vec<byte_t>& binary) -> ownvec<ExportType> {
-  auto types = bin::types(binary);
-  auto imports = bin::imports(binary, types);
-  auto funcs = bin::funcs(binary, imports, types);
-  auto globals = bin::globals(binary, imports);
-  auto tables = bin::tables(binary, imports);
-  auto memories = bin::memories(binary, imports);
-  return bin::exports(binary, funcs, globals, tables, memories);
+  return bin::exports(bin::module_info(binary));
 }
 
 }  // namespace bin
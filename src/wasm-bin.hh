@@ -3,6 +3,8 @@
 
 #include "wasm.hh"
 
+#include <vector>
+
 namespace wasm {
 namespace bin {
 
@@ -12,10 +14,116 @@ void encode_u32(char*& ptr, uint32_t n);
 void encode_u64(char*& ptr, uint64_t n);
 auto u32(const byte_t*& pos) -> uint32_t;
 auto u64(const byte_t*& pos) -> uint64_t;
+void u32_skip(const byte_t*& pos);
+void u32s(const byte_t*& pos, const byte_t* end, uint32_t* out, size_t n);
 
 auto wrapper(const FuncType*) -> vec<byte_t>;
 auto wrapper(const GlobalType*) -> vec<byte_t>;
 
+// Compact module metadata. Names point into the binary the metadata was
+// decoded from, which must outlive it.
+
+using Span = ByteSpan;
+
+// Section index, built in a single pass over the binary. Known sections are
+// indexed by id, custom sections are kept in binary order.
+
+enum sec_t : byte_t {
+  SEC_CUSTOM = 0,
+  SEC_TYPE = 1,
+  SEC_IMPORT = 2,
+  SEC_FUNC = 3,
+  SEC_TABLE = 4,
+  SEC_MEMORY = 5,
+  SEC_GLOBAL = 6,
+  SEC_EXPORT = 7,
+  SEC_START = 8,
+  SEC_ELEM = 9,
+  SEC_CODE = 10,
+  SEC_DATA = 11,
+  SEC_DATACOUNT = 12,
+  SEC_COUNT
+};
+
+struct SectionIndex {
+  const byte_t* binary;
+  Span sections[SEC_COUNT];  // payloads, {nullptr, 0} if absent
+  std::vector<CustomSection> customs;
+
+  auto section(sec_t sec) const -> const byte_t* {
+    return sections[sec].data;
+  }
+  auto section_end(sec_t sec) const -> const byte_t* {
+    return sections[sec].data + sections[sec].size;
+  }
+  auto offset(sec_t sec) const -> size_t {
+    return sections[sec].data - binary;
+  }
+};
+
+auto section_index(const vec<byte_t>& binary) -> SectionIndex;
+auto strip_section(const vec<byte_t>& binary, sec_t) -> vec<byte_t>;
+auto empty_active_segments(
+  const vec<byte_t>& binary, bool data, uint32_t first_table
+) -> vec<byte_t>;
+
+struct SigInfo {
+  uint32_t offset;  // into ModuleInfo::valkinds, params first
+  uint32_t params;
+  uint32_t results;
+};
+
+struct ExternInfo {
+  ExternKind kind;
+  uint32_t sig;  // func: index into ModuleInfo::sigs
+  ValKind content;  // global: content type, table: element type
+  Mutability mutability;  // global only
+  Limits limits;  // table and memory only
+  bool shared;  // memory only
+  bool is64;  // memory only
+
+  ExternInfo() : kind(ExternKind::FUNC), sig(0), content(ValKind::I32),
+    mutability(Mutability::CONST), limits(0), shared(false), is64(false) {}
+};
+
+struct ImportInfo {
+  Span module;
+  Span name;
+  ExternInfo type;
+};
+
+struct ExportInfo {
+  Span name;
+  ExternInfo type;
+  uint32_t index;  // into the index space of the respective kind
+};
+
+struct ModuleInfo {
+  std::vector<ValKind> valkinds;
+  std::vector<SigInfo> sigs;
+  std::vector<ImportInfo> imports;
+  std::vector<ExportInfo> exports;
+};
+
+auto module_info(const SectionIndex&) -> ModuleInfo;
+auto count(const ModuleInfo&, ExternKind) -> uint32_t;  // imports of a kind
+auto module_info(const vec<byte_t>& binary) -> ModuleInfo;
+
+auto externtype(const ModuleInfo&, const ExternInfo&) -> own<ExternType>;
+auto imports(const ModuleInfo&) -> ownvec<ImportType>;
+auto exports(const ModuleInfo&) -> ownvec<ExportType>;
+
+auto func_names(const SectionIndex&, const ModuleInfo&) -> std::vector<Span>;
+auto mutable_ref_globals(const SectionIndex&) -> bool;  // defined ones only
+
+auto matches(const ModuleInfo&, const ExternInfo&, const ExternType*) -> bool;
+
+// Export indices sorted by name, and binary search over them.
+auto export_names(const ModuleInfo&) -> std::vector<uint32_t>;
+auto find_export(
+  const ModuleInfo&, const std::vector<uint32_t>& names, const Span& name
+) -> size_t;  // SIZE_MAX if absent
+
 auto imports(const vec<byte_t>& binary) -> ownvec<ImportType>;
 auto exports(const vec<byte_t>& binary) -> ownvec<ExportType>;
 
@@ -212,6 +212,26 @@ wasm_config_t* wasm_config_new() {
   return release_config(Config::make());
 }
 
+static_assert(sizeof(wasm_allocator_t) == sizeof(AllocatorCallbacks),
+  "C/C++ incompatibility");
+static_assert(sizeof(wasm_allocator_stats_t) == sizeof(AllocatorStats),
+  "C/C++ incompatibility");
+static_assert(sizeof(wasm_handle_stats_t) == sizeof(HandleStats),
+  "C/C++ incompatibility");
+
+void wasm_config_set_allocator_kind(
+  wasm_config_t* config, wasm_allocator_kind_t kind
+) {
+  config->set_allocator(static_cast<AllocatorKind>(kind));
+}
+
+void wasm_config_set_allocator(
+  wasm_config_t* config, const wasm_allocator_t* allocator
+) {
+  config->set_allocator(
+    *reinterpret_cast<const AllocatorCallbacks*>(allocator));
+}
+
 
 // Engine
 
@@ -234,6 +254,55 @@ wasm_store_t* wasm_store_new(wasm_engine_t* engine) {
   return release_store(Store::make(engine));
 };
 
+uint64_t wasm_store_memory_generation(const wasm_store_t* store) {
+  return store->memory_generation();
+}
+
+void wasm_store_allocator_stats(
+  const wasm_store_t* store, wasm_allocator_stats_t* out
+) {
+  *reinterpret_cast<AllocatorStats*>(out) = store->allocator_stats();
+}
+
+void wasm_store_handle_stats(
+  const wasm_store_t* store, wasm_handle_stats_t* out
+) {
+  *reinterpret_cast<HandleStats*>(out) = store->handle_stats();
+}
+
+size_t wasm_store_names_created(const wasm_store_t* store) {
+  return store->names_created();
+}
+
+static_assert(sizeof(wasm_heap_stats_t) == sizeof(HeapStats),
+  "C/C++ incompatibility");
+
+void wasm_store_heap_stats(const wasm_store_t* store, wasm_heap_stats_t* out) {
+  *reinterpret_cast<HeapStats*>(out) = store->heap_stats();
+}
+
+void wasm_store_notify_memory_pressure(
+  wasm_store_t* store, wasm_memory_pressure_t level
+) {
+  store->notify_memory_pressure(static_cast<MemoryPressure>(level));
+}
+
+bool wasm_store_idle_notification(wasm_store_t* store, uint32_t budget_ms) {
+  return store->idle_notification(budget_ms);
+}
+
+void wasm_store_collect(wasm_store_t* store, wasm_collection_kind_t kind) {
+  store->collect(static_cast<CollectionKind>(kind));
+}
+
+void wasm_store_set_deferred_finalizers(wasm_store_t* store, bool defer) {
+  store->set_deferred_finalizers(defer);
+}
+
+size_t wasm_store_run_pending_finalizers(wasm_store_t* store, size_t budget) {
+  return store->run_pending_finalizers(budget);
+}
+
 
 ///////////////////////////////////////////////////////////////////////////////
 // Type Representations
@@ -370,10 +439,27 @@ wasm_memorytype_t* wasm_memorytype_new(const wasm_limits_t* limits) {
   return release_memorytype(MemoryType::make(reveal_limits(*limits)));
 }
 
+wasm_memorytype_t* wasm_memorytype_new_shared(const wasm_limits_t* limits) {
+  return release_memorytype(MemoryType::make(reveal_limits(*limits), true));
+}
+
+wasm_memorytype_t* wasm_memorytype_new_64(const wasm_limits_t* limits, bool shared) {
+  return release_memorytype(
+    MemoryType::make(reveal_limits(*limits), shared, true));
+}
+
 const wasm_limits_t* wasm_memorytype_limits(const wasm_memorytype_t* mt) {
   return hide_limits(mt->limits());
 }
 
+bool wasm_memorytype_is_shared(const wasm_memorytype_t* mt) {
+  return mt->shared();
+}
+
+bool wasm_memorytype_is_64(const wasm_memorytype_t* mt) {
+  return mt->is64();
+}
+
 
 // Extern Types
 
@@ -729,6 +815,8 @@ wasm_foreign_t* wasm_foreign_new(wasm_store_t* store) {
 
 WASM_DEFINE_SHARABLE_REF(module, Module)
 
+WASM_DEFINE_VEC_PLAIN(custom_section, CustomSection)
+
 bool wasm_module_validate(wasm_store_t* store, const wasm_byte_vec_t* binary) {
   auto binary_ = borrow_byte_vec(binary);
   return Module::validate(store, binary_.it);
@@ -754,6 +842,20 @@ void wasm_module_exports(
   *out = release_exporttype_vec(reveal_module(module)->exports());
 }
 
+void wasm_module_custom_sections(
+  const wasm_module_t* module, wasm_custom_section_vec_t* out
+) {
+  *out = release_custom_section_vec(reveal_module(module)->custom_sections());
+}
+
+void wasm_module_func_name(
+  const wasm_module_t* module, uint32_t index, wasm_byte_span_t* out
+) {
+  auto name = reveal_module(module)->func_name(index);
+  out->data = name.data;
+  out->size = name.size;
+}
+
 void wasm_module_serialize(const wasm_module_t* module, wasm_byte_vec_t* out) {
   *out = release_byte_vec(reveal_module(module)->serialize());
 }
@@ -869,6 +971,42 @@ void wasm_global_set(wasm_global_t* global, const wasm_val_t* val) {
   global->set(val_.it);
 }
 
+int32_t wasm_global_get_i32(const wasm_global_t* global) {
+  return global->get_i32();
+}
+
+int64_t wasm_global_get_i64(const wasm_global_t* global) {
+  return global->get_i64();
+}
+
+float32_t wasm_global_get_f32(const wasm_global_t* global) {
+  return global->get_f32();
+}
+
+float64_t wasm_global_get_f64(const wasm_global_t* global) {
+  return global->get_f64();
+}
+
+void wasm_global_set_i32(wasm_global_t* global, int32_t val) {
+  global->set_i32(val);
+}
+
+void wasm_global_set_i64(wasm_global_t* global, int64_t val) {
+  global->set_i64(val);
+}
+
+void wasm_global_set_f32(wasm_global_t* global, float32_t val) {
+  global->set_f32(val);
+}
+
+void wasm_global_set_f64(wasm_global_t* global, float64_t val) {
+  global->set_f64(val);
+}
+
+void* wasm_global_raw_address(const wasm_global_t* global) {
+  return global->raw_address();
+}
+
 
 // Table Instances
 
@@ -904,10 +1042,51 @@ bool wasm_table_grow(
   return table->grow(delta, ref);
 }
 
+bool wasm_table_get_range(
+  const wasm_table_t* table, wasm_table_size_t start, wasm_ref_t* out[],
+  wasm_table_size_t n
+) {
+  auto refs = table->get_range(start, n);
+  if (!refs) return false;
+  for (size_t i = 0; i < n; ++i) out[i] = release_ref(std::move(refs[i]));
+  return true;
+}
+
+bool wasm_table_set_range(
+  wasm_table_t* table, wasm_table_size_t start, wasm_ref_t* const refs[],
+  wasm_table_size_t n
+) {
+  return table->set_range(
+    start, reinterpret_cast<const Ref* const*>(refs), n);
+}
+
+bool wasm_table_fill(
+  wasm_table_t* table, wasm_table_size_t start, wasm_table_size_t n,
+  wasm_ref_t* ref
+) {
+  return table->fill(start, n, ref);
+}
+
+bool wasm_table_copy_from(
+  wasm_table_t* table, wasm_table_size_t dst, const wasm_table_t* src,
+  wasm_table_size_t src_start, wasm_table_size_t n
+) {
+  return table->copy_from(dst, src, src_start, n);
+}
+
+wasm_trap_t* wasm_table_call(
+  const wasm_table_t* table, wasm_table_size_t index,
+  const wasm_val_vec_t* args, wasm_val_vec_t* results
+) {
+  auto args_ = borrow_val_vec(args);
+  auto results_ = borrow_val_vec(results);
+  return release_trap(table->call(index, args_.it, results_.it));
+}
+
 
 // Memory Instances
 
-WASM_DEFINE_REF(memory, Memory)
+WASM_DEFINE_SHARABLE_REF(memory, Memory)
 
 wasm_memory_t* wasm_memory_new(
   wasm_store_t* store, const wasm_memorytype_t* type
@@ -915,10 +1094,37 @@ wasm_memory_t* wasm_memory_new(
   return release_memory(Memory::make(store, type));
 }
 
+static_assert(sizeof(wasm_memory_mapping_t) == sizeof(MemoryMapping),
+  "C/C++ incompatibility");
+
+wasm_memory_t* wasm_memory_new_mapped(
+  wasm_store_t* store, const wasm_memorytype_t* type,
+  const wasm_memory_mapping_t* mapping
+) {
+  return release_memory(Memory::make(
+    store, type, *reinterpret_cast<const MemoryMapping*>(mapping)));
+}
+
+bool wasm_memory_map(wasm_memory_t* memory, const wasm_memory_mapping_t* mapping) {
+  return memory->map(*reinterpret_cast<const MemoryMapping*>(mapping));
+}
+
+bool wasm_memory_discard(wasm_memory_t* memory, size_t offset, size_t size) {
+  return memory->discard(offset, size);
+}
+
 wasm_memorytype_t* wasm_memory_type(const wasm_memory_t* memory) {
   return release_memorytype(memory->type());
 }
 
+wasm_shared_memory_t* wasm_memory_share(const wasm_memory_t* memory) {
+  return release_shared_memory(reveal_memory(memory)->share());
+}
+
+wasm_memory_t* wasm_memory_obtain(wasm_store_t* store, const wasm_shared_memory_t* shared) {
+  return release_memory(Memory::obtain(store, shared));
+}
+
 wasm_byte_t* wasm_memory_data(wasm_memory_t* memory) {
   return memory->data();
 }
@@ -935,6 +1141,76 @@ bool wasm_memory_grow(wasm_memory_t* memory, wasm_memory_pages_t delta) {
   return memory->grow(delta);
 }
 
+static_assert(sizeof(wasm_memory_view_t) == sizeof(MemoryView),
+  "C/C++ incompatibility");
+
+void wasm_memory_view(const wasm_memory_t* memory, wasm_memory_view_t* out) {
+  auto view = memory->view();
+  out->base = view.base;
+  out->size = view.size;
+  out->generation = view.generation;
+}
+
+size_t wasm_memory_dirty_page_size() {
+  return Memory::dirty_page_size();
+}
+
+uint64_t wasm_memory_checkpoint(wasm_memory_t* memory) {
+  return memory->checkpoint();
+}
+
+void wasm_memory_dirty_pages(
+  const wasm_memory_t* memory, uint64_t since_epoch, wasm_byte_vec_t* out
+) {
+  *out = release_byte_vec(memory->dirty_pages(since_epoch));
+}
+
+static_assert(sizeof(wasm_memory_iovec_t) == sizeof(MemoryIovec),
+  "C/C++ incompatibility");
+
+bool wasm_memory_read(
+  const wasm_memory_t* memory, size_t offset, wasm_byte_t* out, size_t size
+) {
+  return memory->read(offset, out, size);
+}
+
+bool wasm_memory_write(
+  wasm_memory_t* memory, size_t offset, const wasm_byte_t* data, size_t size
+) {
+  return memory->write(offset, data, size);
+}
+
+bool wasm_memory_fill(
+  wasm_memory_t* memory, size_t offset, wasm_byte_t value, size_t size
+) {
+  return memory->fill(offset, value, size);
+}
+
+bool wasm_memory_copy_within(
+  wasm_memory_t* memory, size_t dst, size_t src, size_t size
+) {
+  return memory->copy_within(dst, src, size);
+}
+
+bool wasm_memory_copy_from(
+  wasm_memory_t* memory, size_t dst,
+  const wasm_memory_t* src, size_t src_offset, size_t size
+) {
+  return memory->copy_from(dst, src, src_offset, size);
+}
+
+bool wasm_memory_readv(
+  const wasm_memory_t* memory, const wasm_memory_iovec_t iovs[], size_t n
+) {
+  return memory->readv(reinterpret_cast<const MemoryIovec*>(iovs), n);
+}
+
+bool wasm_memory_writev(
+  wasm_memory_t* memory, const wasm_memory_iovec_t iovs[], size_t n
+) {
+  return memory->writev(reinterpret_cast<const MemoryIovec*>(iovs), n);
+}
+
 
 // Externals
 
@@ -1019,12 +1295,164 @@ wasm_instance_t* wasm_instance_new(
   return instance;
 }
 
+bool wasm_instance_new_many(
+  wasm_store_t* store,
+  const wasm_module_t* module,
+  const wasm_extern_vec_t imports[],
+  size_t n,
+  wasm_instance_t* out[],
+  wasm_trap_t** trap
+) {
+  own<Trap> error;
+  auto imports_ = reveal_extern_vec(imports);
+  auto instances = Instance::make_many(store, module, imports_, n, &error);
+  if (trap) *trap = hide_trap(error.release());
+  if (!instances) return false;
+  for (size_t i = 0; i < n; ++i) out[i] = release_instance(std::move(instances[i]));
+  return true;
+}
+
 void wasm_instance_exports(
   const wasm_instance_t* instance, wasm_extern_vec_t* out
 ) {
   *out = release_extern_vec(instance->exports());
 }
 
+wasm_extern_t* wasm_instance_export_by_name(
+  const wasm_instance_t* instance, const wasm_name_t* name
+) {
+  auto name_ = borrow_byte_vec(name);
+  return release_extern(instance->export_by_name(name_.it));
+}
+
+wasm_extern_t* wasm_instance_export_by_index(
+  const wasm_instance_t* instance, size_t index
+) {
+  return release_extern(instance->export_by_index(index));
+}
+
+
+// Instance Snapshots
+
+WASM_DEFINE_OWN(snapshot, Snapshot)
+
+size_t wasm_snapshot_memory_size(const wasm_snapshot_t* snapshot) {
+  return snapshot->memory_size();
+}
+
+wasm_snapshot_t* wasm_instance_snapshot(const wasm_instance_t* instance) {
+  return release_snapshot(instance->snapshot());
+}
+
+wasm_instance_t* wasm_instance_new_from_snapshot(
+  wasm_store_t* store,
+  const wasm_snapshot_t* snapshot,
+  const wasm_extern_vec_t* imports,
+  wasm_trap_t** trap
+) {
+  own<Trap> error;
+  auto imports_ = reveal_extern_vec(imports);
+  auto instance = release_instance(
+    Instance::make_from_snapshot(store, snapshot, *imports_, &error));
+  if (trap) *trap = hide_trap(error.release());
+  return instance;
+}
+
+
+// Instance Hibernation
+
+bool wasm_instance_hibernate(wasm_instance_t* instance, const char* path) {
+  return instance->hibernate(path);
+}
+
+bool wasm_instance_resume(wasm_instance_t* instance, const char* path) {
+  return instance->resume(path);
+}
+
+
+// Instance Pools
+
+WASM_DEFINE_OWN(instance_pool, InstancePool)
+
+wasm_instance_pool_t* wasm_instance_pool_new(
+  wasm_store_t* store,
+  const wasm_module_t* module,
+  const wasm_extern_vec_t* imports,
+  size_t capacity,
+  wasm_trap_t** trap
+) {
+  own<Trap> error;
+  auto imports_ = reveal_extern_vec(imports);
+  auto pool = release_instance_pool(
+    InstancePool::make(store, module, *imports_, capacity, &error));
+  if (trap) *trap = hide_trap(error.release());
+  return pool;
+}
+
+wasm_instance_t* wasm_instance_pool_acquire(
+  wasm_instance_pool_t* pool, wasm_trap_t** trap
+) {
+  own<Trap> error;
+  auto instance = release_instance(pool->acquire(&error));
+  if (trap) *trap = hide_trap(error.release());
+  return instance;
+}
+
+void wasm_instance_pool_release(
+  wasm_instance_pool_t* pool, wasm_instance_t* instance
+) {
+  pool->release(adopt_instance(instance));
+}
+
+size_t wasm_instance_pool_size(const wasm_instance_pool_t* pool) {
+  return pool->size();
+}
+
+size_t wasm_instance_pool_hits(const wasm_instance_pool_t* pool) {
+  return pool->hits();
+}
+
+size_t wasm_instance_pool_misses(const wasm_instance_pool_t* pool) {
+  return pool->misses();
+}
+
+size_t wasm_instance_pool_resets(const wasm_instance_pool_t* pool) {
+  return pool->resets();
+}
+
+uint64_t wasm_instance_pool_reset_nanoseconds(const wasm_instance_pool_t* pool) {
+  return pool->reset_nanoseconds();
+}
+
+
+// Linkers
+
+WASM_DEFINE_OWN(linker, Linker)
+
+wasm_linker_t* wasm_linker_new(
+  wasm_store_t* store, const wasm_module_t* module
+) {
+  return release_linker(Linker::make(store, module));
+}
+
+bool wasm_linker_define(
+  wasm_linker_t* linker, const wasm_name_t* module, const wasm_name_t* name,
+  const wasm_extern_t* external
+) {
+  auto module_ = borrow_byte_vec(module);
+  auto name_ = borrow_byte_vec(name);
+  return linker->define(module_.it, name_.it, external);
+}
+
+wasm_instance_t* wasm_linker_instantiate(
+  wasm_linker_t* linker, wasm_trap_t** trap
+) {
+  own<Trap> error;
+  auto instance = release_instance(linker->instantiate(&error));
+  if (trap) *trap = hide_trap(error.release());
+  return instance;
+}
+
 
 wasm_instance_t* wasm_frame_instance(const wasm_frame_t* frame) {
   return hide_instance(reveal_frame(frame)->instance());
@@ -21,6 +21,8 @@
 
 #include "flags/flags.h"
 
+#include <vector>
+
 
 namespace v8 {
 namespace wasm {
@@ -30,6 +32,7 @@ namespace wasm {
 
 void flags_init() {
   v8::internal::v8_flags.expose_gc = true;
+  v8::internal::v8_flags.experimental_wasm_memory64 = true;
 }
 
 
@@ -198,6 +201,19 @@ auto global_type_content(v8::Local<v8::Object> global) -> val_kind_t {
   return v8_valtype_to_wasm(v8_global->type());
 }
 
+// Reads through the persistent's slot, without a handle scope.
+auto global_object(
+  const v8::Persistent<v8::Object>& global
+) -> v8::internal::Tagged<v8::internal::WasmGlobalObject> {
+  struct FakePersistent { v8::Object* val; };
+  auto v8_obj = reinterpret_cast<const FakePersistent*>(&global)->val;
+  return v8::internal::WasmGlobalObject::cast(*v8::Utils::OpenHandle(v8_obj));
+}
+
+auto global_type_content(const v8::Persistent<v8::Object>& global) -> val_kind_t {
+  return v8_valtype_to_wasm(global_object(global)->type());
+}
+
 auto global_type_mutable(v8::Local<v8::Object> global) -> bool {
   auto v8_object = v8::Utils::OpenHandle<v8::Object, v8::internal::JSReceiver>(global);
   auto v8_global = v8::internal::Handle<v8::internal::WasmGlobalObject>::cast(v8_object);
@@ -228,6 +244,18 @@ auto memory_type_max(v8::Local<v8::Object> memory) -> uint32_t {
   return v8_memory->has_maximum_pages() ? v8_memory->maximum_pages() : 0xffffffffu;
 }
 
+auto memory_type_shared(v8::Local<v8::Object> memory) -> bool {
+  auto v8_object = v8::Utils::OpenHandle<v8::Object, v8::internal::JSReceiver>(memory);
+  auto v8_memory = v8::internal::Handle<v8::internal::WasmMemoryObject>::cast(v8_object);
+  return v8_memory->array_buffer()->is_shared();
+}
+
+auto memory_type_is64(v8::Local<v8::Object> memory) -> bool {
+  auto v8_object = v8::Utils::OpenHandle<v8::Object, v8::internal::JSReceiver>(memory);
+  auto v8_memory = v8::internal::Handle<v8::internal::WasmMemoryObject>::cast(v8_object);
+  return v8_memory->is_memory64();
+}
+
 
 // Modules
 
@@ -297,6 +325,86 @@ auto instance_exports(v8::Local<v8::Object> instance) -> v8::Local<v8::Object> {
   return v8::Utils::ToLocal(v8_exports);
 }
 
+auto instance_memory(v8::Local<v8::Object> instance) -> v8::MaybeLocal<v8::Object> {
+  auto v8_object = v8::Utils::OpenHandle<v8::Object, v8::internal::JSReceiver>(instance);
+  auto v8_instance = v8::internal::Handle<v8::internal::WasmInstanceObject>::cast(v8_object);
+  auto isolate = v8_instance->GetIsolate();
+  auto v8_memories = v8_instance->trusted_data(isolate)->memory_objects();
+  if (v8_memories->length() == 0) return v8::MaybeLocal<v8::Object>();
+  auto v8_memory = object_handle(
+    v8::internal::JSObject::cast(v8_memories->get(0)));
+  return v8::Utils::ToLocal(v8_memory);
+}
+
+auto instance_table_count(v8::Local<v8::Object> instance) -> uint32_t {
+  auto v8_object = v8::Utils::OpenHandle<v8::Object, v8::internal::JSReceiver>(instance);
+  auto v8_instance = v8::internal::Handle<v8::internal::WasmInstanceObject>::cast(v8_object);
+  auto isolate = v8_instance->GetIsolate();
+  return v8_instance->trusted_data(isolate)->tables()->length();
+}
+
+auto instance_table(v8::Local<v8::Object> instance, uint32_t index) -> v8::Local<v8::Object> {
+  auto v8_object = v8::Utils::OpenHandle<v8::Object, v8::internal::JSReceiver>(instance);
+  auto v8_instance = v8::internal::Handle<v8::internal::WasmInstanceObject>::cast(v8_object);
+  auto isolate = v8_instance->GetIsolate();
+  auto v8_tables = v8_instance->trusted_data(isolate)->tables();
+  auto v8_table = object_handle(
+    v8::internal::JSObject::cast(v8_tables->get(index)));
+  return v8::Utils::ToLocal(v8_table);
+}
+
+auto instance_func(v8::Local<v8::Object> instance, uint32_t index) -> v8::Local<v8::Value> {
+  auto v8_object = v8::Utils::OpenHandle<v8::Object, v8::internal::JSReceiver>(instance);
+  auto v8_instance = v8::internal::Handle<v8::internal::WasmInstanceObject>::cast(v8_object);
+  auto isolate = v8_instance->GetIsolate();
+  auto v8_data = i::handle(v8_instance->trusted_data(isolate), isolate);
+  auto v8_func_ref = i::WasmTrustedInstanceData::GetOrCreateFuncRef(
+    isolate, v8_data, static_cast<int>(index));
+  auto v8_func = i::WasmInternalFunction::GetOrCreateExternal(
+    i::handle(v8_func_ref->internal(isolate), isolate));
+  return v8::Utils::ToLocal(v8::internal::Handle<v8::internal::Object>::cast(v8_func));
+}
+
+auto instance_globals_data(v8::Local<v8::Object> instance) -> char* {
+  auto v8_object = v8::Utils::OpenHandle<v8::Object, v8::internal::JSReceiver>(instance);
+  auto v8_instance = v8::internal::Handle<v8::internal::WasmInstanceObject>::cast(v8_object);
+  auto isolate = v8_instance->GetIsolate();
+  return reinterpret_cast<char*>(
+    v8_instance->trusted_data(isolate)->globals_start());
+}
+
+auto instance_globals_size(v8::Local<v8::Object> instance) -> size_t {
+  auto v8_object = v8::Utils::OpenHandle<v8::Object, v8::internal::JSReceiver>(instance);
+  auto v8_instance = v8::internal::Handle<v8::internal::WasmInstanceObject>::cast(v8_object);
+  auto isolate = v8_instance->GetIsolate();
+  return v8_instance->trusted_data(isolate)->module()->untagged_globals_buffer_size;
+}
+
+auto instance_global_count(v8::Local<v8::Object> instance) -> uint32_t {
+  auto v8_object = v8::Utils::OpenHandle<v8::Object, v8::internal::JSReceiver>(instance);
+  auto v8_instance = v8::internal::Handle<v8::internal::WasmInstanceObject>::cast(v8_object);
+  auto isolate = v8_instance->GetIsolate();
+  return static_cast<uint32_t>(
+    v8_instance->trusted_data(isolate)->module()->globals.size());
+}
+
+// The range of a global in the untagged globals buffer, only for globals
+// defined by the module that are mutable and numeric.
+auto instance_global_span(
+  v8::Local<v8::Object> instance, uint32_t index, size_t* offset, size_t* size
+) -> bool {
+  auto v8_object = v8::Utils::OpenHandle<v8::Object, v8::internal::JSReceiver>(instance);
+  auto v8_instance = v8::internal::Handle<v8::internal::WasmInstanceObject>::cast(v8_object);
+  auto isolate = v8_instance->GetIsolate();
+  auto& global = v8_instance->trusted_data(isolate)->module()->globals[index];
+  if (global.imported || !global.mutability || global.type.is_reference()) {
+    return false;
+  }
+  *offset = global.offset;
+  *size = global.type.value_kind_size();
+  return true;
+}
+
 
 // Externals
 
@@ -320,6 +428,12 @@ auto func_instance(v8::Local<v8::Function> function) -> v8::Local<v8::Object> {
   return v8::Utils::ToLocal(v8_instance);
 }
 
+auto func_index(v8::Local<v8::Function> function) -> uint32_t {
+  auto v8_function = v8::Utils::OpenHandle(*function);
+  auto v8_func = v8::internal::Handle<v8::internal::WasmExportedFunction>::cast(v8_function);
+  return v8_func->shared()->wasm_exported_function_data()->function_index();
+}
+
 
 // Globals
 
@@ -349,6 +463,12 @@ auto global_get_ref(v8::Local<v8::Object> global) -> v8::Local<v8::Value> {
   return v8::Utils::ToLocal(v8_global->GetRef());
 }
 
+// Numeric globals live off-heap, in their untagged buffer, so the address
+// is stable. Imported globals are accessed through the same address.
+auto global_address(const v8::Persistent<v8::Object>& global) -> void* {
+  return reinterpret_cast<void*>(global_object(global)->address());
+}
+
 void global_set_i32(v8::Local<v8::Object> global, int32_t val) {
   auto v8_object = v8::Utils::OpenHandle<v8::Object, v8::internal::JSReceiver>(global);
   auto v8_global = v8::internal::Handle<v8::internal::WasmGlobalObject>::cast(v8_object);
@@ -378,6 +498,27 @@ void global_set_ref(v8::Local<v8::Object> global, v8::Local<v8::Value> val) {
 
 // Tables
 
+// Converts a table entry to its JS representation, null if empty.
+auto table_entry_to_js(
+  i::Isolate* isolate, v8::internal::Handle<v8::internal::Object> v8_value
+) -> v8::internal::Handle<v8::internal::Object> {
+  if (v8::internal::IsWasmFuncRef(*v8_value)) {
+    return i::WasmInternalFunction::GetOrCreateExternal(
+        i::handle(i::WasmFuncRef::cast(*v8_value)->internal(isolate), isolate));
+  } else if (v8::internal::IsWasmNull(*v8_value)) {
+    return isolate->factory()->null_value();
+  }
+  return v8_value;
+}
+
+auto table_range_in_bounds(
+  v8::internal::Handle<v8::internal::WasmTableObject> v8_table,
+  size_t start, size_t n
+) -> bool {
+  auto size = size_t(v8_table->current_length());
+  return start <= size && n <= size - start;
+}
+
 auto table_get(v8::Local<v8::Object> table, size_t index) -> v8::MaybeLocal<v8::Value> {
   auto v8_object = v8::Utils::OpenHandle<v8::Object, v8::internal::JSReceiver>(table);
   auto v8_table = v8::internal::Handle<v8::internal::WasmTableObject>::cast(v8_object);
@@ -386,18 +527,12 @@ auto table_get(v8::Local<v8::Object> table, size_t index) -> v8::MaybeLocal<v8::
     return v8::MaybeLocal<v8::Value>();
 
   i::Isolate* isolate = v8_table->GetIsolate();
-  v8::internal::Handle<v8::internal::Object> v8_value =
+  auto v8_value = table_entry_to_js(isolate,
     v8::internal::WasmTableObject::Get(
-      v8_table->GetIsolate(), v8_table, static_cast<uint32_t>(index));
+      isolate, v8_table, static_cast<uint32_t>(index)));
+  if (v8::internal::IsNull(*v8_value)) return Local<v8::Value>();
 
-  if (v8::internal::IsWasmFuncRef(*v8_value)) {
-    v8_value = i::WasmInternalFunction::GetOrCreateExternal(
-        i::handle(i::WasmFuncRef::cast(*v8_value)->internal(isolate), isolate));
-  } else if (v8::internal::IsWasmNull(*v8_value) || v8::internal::IsNull(*v8_value)) {
-    return Local<v8::Value>();
-  }
-
-  return v8::Utils::ToLocal(v8::internal::Handle<v8::internal::Object>::cast(v8_value));
+  return v8::Utils::ToLocal(v8_value);
 }
 
 auto table_set(
@@ -422,6 +557,100 @@ auto table_set(
   return true;
 }
 
+// Bulk operations check bounds and convert values up front, so that they
+// fail without effect, and then operate on the table directly.
+
+auto table_get_range(
+  v8::Local<v8::Object> table, size_t start, size_t n, v8::Local<v8::Value> out[]
+) -> bool {
+  auto v8_object = v8::Utils::OpenHandle<v8::Object, v8::internal::JSReceiver>(table);
+  auto v8_table = v8::internal::Handle<v8::internal::WasmTableObject>::cast(v8_object);
+  if (!table_range_in_bounds(v8_table, start, n)) return false;
+  auto isolate = v8_table->GetIsolate();
+  for (size_t i = 0; i < n; ++i) {
+    out[i] = v8::Utils::ToLocal(table_entry_to_js(isolate,
+      v8::internal::WasmTableObject::Get(
+        isolate, v8_table, static_cast<uint32_t>(start + i))));
+  }
+  return true;
+}
+
+auto table_set_range(
+  v8::Local<v8::Object> table, size_t start, size_t n,
+  const v8::Local<v8::Value> values[]
+) -> bool {
+  auto v8_object = v8::Utils::OpenHandle<v8::Object, v8::internal::JSReceiver>(table);
+  auto v8_table = v8::internal::Handle<v8::internal::WasmTableObject>::cast(v8_object);
+  if (!table_range_in_bounds(v8_table, start, n)) return false;
+  auto isolate = v8_table->GetIsolate();
+  auto type = v8_table->type();
+  std::vector<v8::internal::Handle<v8::internal::Object>> entries(n);
+  for (size_t i = 0; i < n; ++i) {
+    const char* error_message;
+    auto v8_value = v8::Utils::OpenHandle<v8::Value, v8::internal::Object>(values[i]);
+    if (!i::wasm::JSToWasmObject(isolate, nullptr, v8_value, type,
+          &error_message).ToHandle(&entries[i])) {
+      return false;
+    }
+  }
+  v8::TryCatch handler(table->GetIsolate());
+  for (size_t i = 0; i < n; ++i) {
+    v8::internal::WasmTableObject::Set(isolate, v8_table,
+      static_cast<uint32_t>(start + i), entries[i]);
+  }
+  return !handler.HasCaught();
+}
+
+auto table_fill(
+  v8::Local<v8::Object> table, size_t start, size_t n, v8::Local<v8::Value> value
+) -> bool {
+  auto v8_object = v8::Utils::OpenHandle<v8::Object, v8::internal::JSReceiver>(table);
+  auto v8_table = v8::internal::Handle<v8::internal::WasmTableObject>::cast(v8_object);
+  if (!table_range_in_bounds(v8_table, start, n)) return false;
+  auto isolate = v8_table->GetIsolate();
+  const char* error_message;
+  auto v8_value = v8::Utils::OpenHandle<v8::Value, v8::internal::Object>(value);
+  v8::internal::Handle<v8::internal::Object> entry;
+  if (!i::wasm::JSToWasmObject(isolate, nullptr, v8_value, v8_table->type(),
+        &error_message).ToHandle(&entry)) {
+    return false;
+  }
+  if (n == 0) return true;
+  v8::TryCatch handler(table->GetIsolate());
+  v8::internal::WasmTableObject::Fill(isolate, v8_table,
+    static_cast<uint32_t>(start), entry, static_cast<uint32_t>(n));
+  return !handler.HasCaught();
+}
+
+// Entries are already in table representation and need no conversion.
+// Overlapping ranges within one table are copied as if through a buffer.
+auto table_copy(
+  v8::Local<v8::Object> dst_table, size_t dst,
+  v8::Local<v8::Object> src_table, size_t src, size_t n
+) -> bool {
+  auto v8_dst_object = v8::Utils::OpenHandle<v8::Object, v8::internal::JSReceiver>(dst_table);
+  auto v8_dst = v8::internal::Handle<v8::internal::WasmTableObject>::cast(v8_dst_object);
+  auto v8_src_object = v8::Utils::OpenHandle<v8::Object, v8::internal::JSReceiver>(src_table);
+  auto v8_src = v8::internal::Handle<v8::internal::WasmTableObject>::cast(v8_src_object);
+  auto isolate = v8_dst->GetIsolate();
+  if (v8_src->GetIsolate() != isolate || v8_src->type() != v8_dst->type() ||
+      !table_range_in_bounds(v8_dst, dst, n) ||
+      !table_range_in_bounds(v8_src, src, n)) {
+    return false;
+  }
+  auto backwards = v8_dst.is_identical_to(v8_src) && dst > src;
+  v8::TryCatch handler(dst_table->GetIsolate());
+  for (size_t k = 0; k < n; ++k) {
+    auto i = backwards ? n - 1 - k : k;
+    v8::internal::HandleScope handle_scope(isolate);
+    auto entry = v8::internal::WasmTableObject::Get(
+      isolate, v8_src, static_cast<uint32_t>(src + i));
+    v8::internal::WasmTableObject::Set(
+      isolate, v8_dst, static_cast<uint32_t>(dst + i), entry);
+  }
+  return !handler.HasCaught();
+}
+
 auto table_size(v8::Local<v8::Object> table) -> size_t {
   auto v8_object = v8::Utils::OpenHandle<v8::Object, v8::internal::JSReceiver>(table);
   auto v8_table = v8::internal::Handle<v8::internal::WasmTableObject>::cast(v8_object);
@@ -471,6 +700,19 @@ auto memory_data_size(v8::Local<v8::Object> memory)-> size_t {
   return v8_memory->array_buffer()->byte_length();
 }
 
+// Reads through the handle's slot, without a handle scope.
+void memory_extent(
+  const v8::PersistentBase<v8::Object>& memory, char** data, size_t* size
+) {
+  struct FakePersistent { v8::Object* val; };
+  auto v8_obj = reinterpret_cast<const FakePersistent*>(&memory)->val;
+  auto v8_memory =
+    v8::internal::WasmMemoryObject::cast(*v8::Utils::OpenHandle(v8_obj));
+  auto buffer = v8_memory->array_buffer();
+  *data = reinterpret_cast<char*>(buffer->backing_store());
+  *size = buffer->byte_length();
+}
+
 auto memory_size(v8::Local<v8::Object> memory) -> uint32_t {
   auto v8_object = v8::Utils::OpenHandle<v8::Object, v8::internal::JSReceiver>(memory);
   auto v8_memory = v8::internal::Handle<v8::internal::WasmMemoryObject>::cast(v8_object);
@@ -486,6 +728,33 @@ auto memory_grow(v8::Local<v8::Object> memory, uint32_t delta) -> bool {
   return old != -1;
 }
 
+auto memory_backing_store(v8::Local<v8::Object> memory) -> std::shared_ptr<v8::BackingStore> {
+  auto v8_object = v8::Utils::OpenHandle<v8::Object, v8::internal::JSReceiver>(memory);
+  auto v8_memory = v8::internal::Handle<v8::internal::WasmMemoryObject>::cast(v8_object);
+  auto isolate = v8_memory->GetIsolate();
+  v8::internal::Handle<v8::internal::JSArrayBuffer> v8_buffer(
+    v8_memory->array_buffer(), isolate);
+  return v8::Utils::ToLocalShared(v8_buffer)->GetBackingStore();
+}
+
+// Wraps a shared backing store in a new memory object of the given isolate.
+// Attaching it to the backing store makes grows in any isolate visible here.
+auto memory_new_shared(
+  v8::Isolate* isolate, std::shared_ptr<v8::BackingStore> backing_store,
+  uint32_t max, bool is64
+) -> v8::Local<v8::Object> {
+  auto v8_isolate = reinterpret_cast<v8::internal::Isolate*>(isolate);
+  auto buffer = v8::SharedArrayBuffer::New(isolate, std::move(backing_store));
+  auto v8_buffer = v8::Utils::OpenHandle(*buffer);
+  auto v8_memory = v8::internal::WasmMemoryObject::New(
+    v8_isolate, v8_buffer,
+    max == 0xffffffffu ? -1 : static_cast<int>(max),
+    is64 ? v8::internal::WasmMemoryFlag::kWasmMemory64
+         : v8::internal::WasmMemoryFlag::kWasmMemory32);
+  return v8::Utils::ToLocal(
+    v8::internal::Handle<v8::internal::JSObject>::cast(v8_memory));
+}
+
 }  // namespace wasm
 
 template class internal::Managed<wasm::ManagedData>;
@@ -32,6 +32,7 @@ auto func_type_param(v8::Local<v8::Object> global, size_t) -> val_kind_t;
 auto func_type_result(v8::Local<v8::Object> global, size_t) -> val_kind_t;
 
 auto global_type_content(v8::Local<v8::Object> global) -> val_kind_t;
+auto global_type_content(const v8::Persistent<v8::Object>& global) -> val_kind_t;
 auto global_type_mutable(v8::Local<v8::Object> global) -> bool;
 
 auto table_type_min(v8::Local<v8::Object> table) -> uint32_t;
@@ -39,6 +40,8 @@ auto table_type_max(v8::Local<v8::Object> table) -> uint32_t;
 
 auto memory_type_min(v8::Local<v8::Object> memory) -> uint32_t;
 auto memory_type_max(v8::Local<v8::Object> memory) -> uint32_t;
+auto memory_type_shared(v8::Local<v8::Object> memory) -> bool;
+auto memory_type_is64(v8::Local<v8::Object> memory) -> bool;
 
 auto module_binary_size(v8::Local<v8::Object> module) -> size_t;
 auto module_binary(v8::Local<v8::Object> module) -> const char*;
@@ -49,17 +52,27 @@ auto module_deserialize(v8::Isolate*, const uint8_t*, size_t, const uint8_t*, si
 
 auto instance_module(v8::Local<v8::Object> instance) -> v8::Local<v8::Object>;
 auto instance_exports(v8::Local<v8::Object> instance) -> v8::Local<v8::Object>;
+auto instance_memory(v8::Local<v8::Object> instance) -> v8::MaybeLocal<v8::Object>;
+auto instance_table_count(v8::Local<v8::Object> instance) -> uint32_t;
+auto instance_table(v8::Local<v8::Object> instance, uint32_t) -> v8::Local<v8::Object>;
+auto instance_func(v8::Local<v8::Object> instance, uint32_t) -> v8::Local<v8::Value>;
+auto instance_globals_data(v8::Local<v8::Object> instance) -> char*;
+auto instance_globals_size(v8::Local<v8::Object> instance) -> size_t;
+auto instance_global_count(v8::Local<v8::Object> instance) -> uint32_t;
+auto instance_global_span(v8::Local<v8::Object> instance, uint32_t, size_t* offset, size_t* size) -> bool;
 
 enum extern_kind_t { EXTERN_FUNC, EXTERN_GLOBAL, EXTERN_TABLE, EXTERN_MEMORY };
 auto extern_kind(v8::Local<v8::Object> external) -> extern_kind_t;
 
 auto func_instance(v8::Local<v8::Function>) -> v8::Local<v8::Object>;
+auto func_index(v8::Local<v8::Function>) -> uint32_t;
 
 auto global_get_i32(v8::Local<v8::Object> global) -> int32_t;
 auto global_get_i64(v8::Local<v8::Object> global) -> int64_t;
 auto global_get_f32(v8::Local<v8::Object> global) -> float;
 auto global_get_f64(v8::Local<v8::Object> global) -> double;
 auto global_get_ref(v8::Local<v8::Object> global) -> v8::Local<v8::Value>;
+auto global_address(const v8::Persistent<v8::Object>& global) -> void*;
 void global_set_i32(v8::Local<v8::Object> global, int32_t);
 void global_set_i64(v8::Local<v8::Object> global, int64_t);
 void global_set_f32(v8::Local<v8::Object> global, float);
@@ -70,11 +83,18 @@ auto table_get(v8::Local<v8::Object> table, size_t index) -> v8::MaybeLocal<v8::
 auto table_set(v8::Local<v8::Object> table, size_t index, v8::Local<v8::Value>) -> bool;
 auto table_size(v8::Local<v8::Object> table) -> size_t;
 auto table_grow(v8::Local<v8::Object> table, size_t delta, v8::Local<v8::Value>) -> bool;
+auto table_get_range(v8::Local<v8::Object> table, size_t start, size_t n, v8::Local<v8::Value> out[]) -> bool;
+auto table_set_range(v8::Local<v8::Object> table, size_t start, size_t n, const v8::Local<v8::Value> values[]) -> bool;
+auto table_fill(v8::Local<v8::Object> table, size_t start, size_t n, v8::Local<v8::Value>) -> bool;
+auto table_copy(v8::Local<v8::Object> dst_table, size_t dst, v8::Local<v8::Object> src_table, size_t src, size_t n) -> bool;
 
 auto memory_data(v8::Local<v8::Object> memory) -> char*;
 auto memory_data_size(v8::Local<v8::Object> memory)-> size_t;
+void memory_extent(const v8::PersistentBase<v8::Object>& memory, char** data, size_t* size);
 auto memory_size(v8::Local<v8::Object> memory) -> uint32_t;
 auto memory_grow(v8::Local<v8::Object> memory, uint32_t delta) -> bool;
+auto memory_backing_store(v8::Local<v8::Object> memory) -> std::shared_ptr<v8::BackingStore>;
+auto memory_new_shared(v8::Isolate*, std::shared_ptr<v8::BackingStore>, uint32_t max, bool is64) -> v8::Local<v8::Object>;
 
 }  // namespace wasm
 }  // namespace v8
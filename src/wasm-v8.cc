@@ -8,10 +8,19 @@
 
 #include <iostream>
 #include <type_traits>
+#include <cstdio>
 #include <cstring>
-
-#ifdef WASM_API_DEBUG
+#include <chrono>
+#include <algorithm>
 #include <atomic>
+#include <mutex>
+#include <new>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #endif
 
 
@@ -54,9 +63,10 @@ struct Stats {
   enum category_t {
     BYTE, CONFIG, ENGINE, STORE, FRAME,
     VALTYPE, FUNCTYPE, GLOBALTYPE, TABLETYPE, MEMORYTYPE,
-    EXTERNTYPE, IMPORTTYPE, EXPORTTYPE,
+    EXTERNTYPE, IMPORTTYPE, EXPORTTYPE, CUSTOMSECTION,
     VAL, REF, TRAP,
     MODULE, INSTANCE, FUNC, GLOBAL, TABLE, MEMORY, EXTERN,
+    LINKER, SNAPSHOT, INSTANCEPOOL,
     STRONG_COUNT,
     FUNCDATA_FUNCTYPE, FUNCDATA_VALTYPE,
     CATEGORY_COUNT
@@ -171,9 +181,10 @@ template<> struct categorize<Trap> { static const auto value = Stats::TRAP; };
 const char* Stats::name[STRONG_COUNT] = {
   "byte_t", "Config", "Engine", "Store", "Frame",
   "ValType", "FuncType", "GlobalType", "TableType", "MemoryType",
-  "ExternType", "ImportType", "ExportType",
+  "ExternType", "ImportType", "ExportType", "CustomSection",
   "Val", "Ref", "Trap",
-  "Module", "Instance", "Func", "Global", "Table", "Memory", "Extern"
+  "Module", "Instance", "Func", "Global", "Table", "Memory", "Extern",
+  "Linker", "Snapshot", "InstancePool"
 };
 
 const char* Stats::left[CARDINALITY_COUNT] = {
@@ -212,6 +223,7 @@ DEFINE_VEC(MemoryType, ownvec, MEMORYTYPE)
 DEFINE_VEC(ExternType, ownvec, EXTERNTYPE)
 DEFINE_VEC(ImportType, ownvec, IMPORTTYPE)
 DEFINE_VEC(ExportType, ownvec, EXPORTTYPE)
+DEFINE_VEC(CustomSection, vec, CUSTOMSECTION)
 DEFINE_VEC(Ref, ownvec, REF)
 DEFINE_VEC(Trap, ownvec, TRAP)
 DEFINE_VEC(Module, ownvec, MODULE)
@@ -233,6 +245,9 @@ DEFINE_VEC(Val, vec, VAL)
 // Configuration
 
 struct ConfigImpl : Config {
+  AllocatorKind allocator_kind = AllocatorKind::DEFAULT;
+  AllocatorCallbacks allocator_callbacks = {};
+
   ConfigImpl() { stats.make(Stats::CONFIG, this); }
   ~ConfigImpl() { stats.free(Stats::CONFIG, this); }
 };
@@ -248,6 +263,24 @@ auto Config::make() -> own<Config> {
   return own<Config>(new(std::nothrow) ConfigImpl());
 }
 
+void Config::set_allocator(AllocatorKind kind) {
+  auto& callbacks = impl(this)->allocator_callbacks;
+  if (kind == AllocatorKind::CUSTOM && !(callbacks.allocate && callbacks.free)) {
+    kind = AllocatorKind::DEFAULT;
+  }
+  impl(this)->allocator_kind = kind;
+}
+
+void Config::set_allocator(const AllocatorCallbacks& callbacks) {
+  if (!(callbacks.allocate && callbacks.free)) {
+    impl(this)->allocator_kind = AllocatorKind::DEFAULT;
+    impl(this)->allocator_callbacks = {};
+    return;
+  }
+  impl(this)->allocator_kind = AllocatorKind::CUSTOM;
+  impl(this)->allocator_callbacks = callbacks;
+}
+
 
 // Engine
 
@@ -255,6 +288,8 @@ struct EngineImpl : Engine {
   static bool created;
 
   std::unique_ptr<v8::Platform> platform;
+  AllocatorKind allocator_kind = AllocatorKind::DEFAULT;
+  AllocatorCallbacks allocator_callbacks = {};
 
   EngineImpl() {
     assert(!created);
@@ -283,6 +318,10 @@ auto Engine::make(own<Config>&& config) -> own<Engine> {
   // v8::V8::SetFlagsFromCommandLine(&argc, const_cast<char**>(argv), false);
   auto engine = new(std::nothrow) EngineImpl;
   if (!engine) return own<Engine>();
+  if (config) {
+    engine->allocator_kind = impl(config.get())->allocator_kind;
+    engine->allocator_callbacks = impl(config.get())->allocator_callbacks;
+  }
   // v8::V8::InitializeICUDefaultLocation(argv[0]);
   // v8::V8::InitializeExternalStartupData(argv[0]);
   engine->platform = v8::platform::NewDefaultPlatform();
@@ -292,13 +331,171 @@ auto Engine::make(own<Config>&& config) -> own<Engine> {
 }
 
 
+// Array Buffer Allocators
+
+// Backs the array buffers of one store. V8 may free buffers from background
+// threads, so all state is guarded by a mutex.
+
+class StoreAllocator : public v8::ArrayBuffer::Allocator {
+  static const size_t kMinClass = 6;  // 64 bytes
+  static const size_t kMaxClass = 26;  // 64 MiB, larger sizes are not pooled
+  static const size_t kHugePage = 2 * 1024 * 1024;
+
+  AllocatorKind kind_;
+  AllocatorCallbacks callbacks_;
+  std::unique_ptr<v8::ArrayBuffer::Allocator> default_;
+  std::vector<void*> free_lists_[kMaxClass + 1];
+  AllocatorStats stats_ = {};
+  mutable std::mutex mutex_;
+
+  static auto size_class(size_t size) -> size_t {
+    auto c = kMinClass;
+    while (c <= kMaxClass && (size_t(1) << c) < size) ++c;
+    return c;
+  }
+
+  void count_allocation(size_t size) {
+    ++stats_.allocations;
+    stats_.live_bytes += size;
+    stats_.peak_bytes = std::max(stats_.peak_bytes, stats_.live_bytes);
+  }
+
+  auto allocate(size_t length, bool zeroed) -> void* {
+    void* data = nullptr;
+    switch (kind_) {
+      case AllocatorKind::DEFAULT: {
+        data = zeroed ? default_->Allocate(length)
+          : default_->AllocateUninitialized(length);
+      } break;
+      case AllocatorKind::HUGE_PAGE: {
+#ifdef __linux__
+        if (length >= kHugePage) {
+          auto size = (length + kHugePage - 1) / kHugePage * kHugePage;
+          data = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+          auto huge = data != MAP_FAILED;
+          if (!huge) {
+            data = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+              MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (data == MAP_FAILED) return nullptr;
+            madvise(data, size, MADV_HUGEPAGE);
+          }
+          std::lock_guard<std::mutex> lock(mutex_);
+          if (huge) {
+            stats_.huge_page_bytes += size;
+          } else {
+            stats_.advised_huge_page_bytes += size;
+          }
+          count_allocation(length);
+          return data;
+        }
+#endif
+        data = zeroed ? default_->Allocate(length)
+          : default_->AllocateUninitialized(length);
+      } break;
+      case AllocatorKind::ARENA: {
+        auto c = size_class(length);
+        if (c <= kMaxClass) {
+          std::lock_guard<std::mutex> lock(mutex_);
+          if (!free_lists_[c].empty()) {
+            data = free_lists_[c].back();
+            free_lists_[c].pop_back();
+            if (zeroed) std::memset(data, 0, length);
+            ++stats_.reuses;
+            count_allocation(length);
+            return data;
+          }
+        }
+        auto size = c <= kMaxClass ? size_t(1) << c : length;
+        data = zeroed ? default_->Allocate(size)
+          : default_->AllocateUninitialized(size);
+      } break;
+      case AllocatorKind::CUSTOM: {
+        data = callbacks_.allocate(callbacks_.env, length);
+      } break;
+    }
+    if (!data) return nullptr;
+    std::lock_guard<std::mutex> lock(mutex_);
+    count_allocation(length);
+    return data;
+  }
+
+public:
+  StoreAllocator(AllocatorKind kind, const AllocatorCallbacks& callbacks) :
+    kind_(kind), callbacks_(callbacks),
+    default_(v8::ArrayBuffer::Allocator::NewDefaultAllocator()) {}
+
+  ~StoreAllocator() override {
+    for (size_t c = kMinClass; c <= kMaxClass; ++c) {
+      for (auto data : free_lists_[c]) default_->Free(data, size_t(1) << c);
+    }
+  }
+
+  auto Allocate(size_t length) -> void* override {
+    return allocate(length, true);
+  }
+
+  auto AllocateUninitialized(size_t length) -> void* override {
+    return allocate(length, false);
+  }
+
+  void Free(void* data, size_t length) override {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      ++stats_.frees;
+      stats_.live_bytes -= length;
+    }
+    switch (kind_) {
+      case AllocatorKind::DEFAULT: {
+        default_->Free(data, length);
+      } break;
+      case AllocatorKind::HUGE_PAGE: {
+#ifdef __linux__
+        if (length >= kHugePage) {
+          munmap(data, (length + kHugePage - 1) / kHugePage * kHugePage);
+          return;
+        }
+#endif
+        default_->Free(data, length);
+      } break;
+      case AllocatorKind::ARENA: {
+        auto c = size_class(length);
+        if (c <= kMaxClass) {
+          std::lock_guard<std::mutex> lock(mutex_);
+          free_lists_[c].push_back(data);
+          return;
+        }
+        default_->Free(data, length);
+      } break;
+      case AllocatorKind::CUSTOM: {
+        callbacks_.free(callbacks_.env, data, length);
+      } break;
+    }
+  }
+
+  auto kind() const -> AllocatorKind {
+    return kind_;
+  }
+
+  auto stats() const -> AllocatorStats {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+  }
+
+  void count_advised_huge_pages(size_t size) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.advised_huge_page_bytes += size;
+  }
+};
+
+
 // Stores
 
 enum v8_string_t {
   V8_S_EMPTY,
   V8_S_I32, V8_S_I64, V8_S_F32, V8_S_F64, V8_S_EXTERNREF, V8_S_FUNCREF,
   V8_S_VALUE, V8_S_MUTABLE, V8_S_ELEMENT, V8_S_MINIMUM, V8_S_MAXIMUM,
-  V8_S_ANYFUNC,
+  V8_S_ANYFUNC, V8_S_SHARED, V8_S_INDEX,
   V8_S_COUNT
 };
 
@@ -307,13 +504,201 @@ enum v8_symbol_t {
   V8_Y_COUNT
 };
 
+enum v8_private_t {
+  V8_P_MODULE_DATA,
+  V8_P_MODULE_NAMES,
+  V8_P_COUNT
+};
+
 enum v8_function_t {
-  V8_F_WEAKMAP, V8_F_WEAKMAP_PROTO, V8_F_WEAKMAP_GET, V8_F_WEAKMAP_SET,
   V8_F_MODULE, V8_F_GLOBAL, V8_F_TABLE, V8_F_MEMORY,
   V8_F_INSTANCE, V8_F_VALIDATE,
   V8_F_COUNT,
 };
 
+// Dirty page tracking state of a memory, see Memory::checkpoint. Trackers
+// are registered process-wide, because clearing soft-dirty bits is.
+
+struct DirtyTracker;
+struct StoreImpl;
+
+#ifdef __linux__
+std::mutex dirty_mutex;
+std::vector<DirtyTracker*> dirty_trackers;
+#endif
+
+struct DirtyTracker {
+  struct PageHash {
+    uint64_t lo, hi;
+  };
+
+  v8::Global<v8::Object> memory;  // weak
+  const StoreImpl* store = nullptr;
+  uint64_t epoch = 0;  // 0 before the first checkpoint
+  bool soft_dirty = false;
+  byte_t* base = nullptr;  // as of the checkpoint
+  size_t size = 0;
+  std::vector<byte_t> dirty;  // bits saved by other checkpoints or discards
+  std::vector<PageHash> hashes;  // per page, without soft-dirty bits
+
+  DirtyTracker() {
+#ifdef __linux__
+    std::lock_guard<std::mutex> lock(dirty_mutex);
+    dirty_trackers.push_back(this);
+#endif
+  }
+
+  ~DirtyTracker() {
+#ifdef __linux__
+    std::lock_guard<std::mutex> lock(dirty_mutex);
+    dirty_trackers.erase(
+      std::find(dirty_trackers.begin(), dirty_trackers.end(), this));
+#endif
+  }
+};
+
+// Ref handles, carved out of aligned slabs so that the slab of a handle is
+// found by masking its address. Each slab threads a free list through its
+// unused slots. Slabs with free slots are kept in a list, partially used ones
+// first, so that live handles stay packed; empty slabs at its tail are
+// released while the remaining capacity is less than half in use.
+
+class HandleArena {
+public:
+  using Handle = v8::Persistent<v8::Object>;
+
+private:
+  static const size_t kSlabSize = 16 * 1024;
+
+  union Slot {
+    Slot* next;
+    alignas(Handle) char handle[sizeof(Handle)];
+  };
+
+  struct Slab {
+    Slab* prev;  // in the list of slabs with free slots
+    Slab* next;
+    Slot* free;
+    size_t live;
+
+    auto slots() -> Slot* {
+      return reinterpret_cast<Slot*>(this + 1);
+    }
+  };
+
+  static_assert(sizeof(Slab) % alignof(Slot) == 0, "misaligned slots");
+  static const size_t kSlabSlots = (kSlabSize - sizeof(Slab)) / sizeof(Slot);
+
+  Slab* head_ = nullptr;  // slabs with free slots
+  Slab* tail_ = nullptr;
+  std::vector<Slab*> slabs_;
+  HandleStats stats_ = {};
+
+  static auto slab_of(Slot* slot) -> Slab* {
+    return reinterpret_cast<Slab*>(
+      reinterpret_cast<uintptr_t>(slot) & ~uintptr_t(kSlabSize - 1));
+  }
+
+  void link_front(Slab* slab) {
+    slab->prev = nullptr;
+    slab->next = head_;
+    (head_ ? head_->prev : tail_) = slab;
+    head_ = slab;
+  }
+
+  void link_back(Slab* slab) {
+    slab->prev = tail_;
+    slab->next = nullptr;
+    (tail_ ? tail_->next : head_) = slab;
+    tail_ = slab;
+  }
+
+  void unlink(Slab* slab) {
+    (slab->prev ? slab->prev->next : head_) = slab->next;
+    (slab->next ? slab->next->prev : tail_) = slab->prev;
+  }
+
+  auto grow() -> bool {
+    auto slab = static_cast<Slab*>(operator new(kSlabSize,
+      std::align_val_t(kSlabSize), std::nothrow));
+    if (!slab) return false;
+    auto slots = slab->slots();
+    for (size_t i = 0; i + 1 < kSlabSlots; ++i) slots[i].next = &slots[i + 1];
+    slots[kSlabSlots - 1].next = nullptr;
+    slab->free = slots;
+    slab->live = 0;
+    slabs_.push_back(slab);
+    link_front(slab);
+    ++stats_.slabs;
+    ++stats_.slab_allocations;
+    stats_.capacity += kSlabSlots;
+    return true;
+  }
+
+  void release(Slab* slab) {
+    unlink(slab);
+    slabs_.erase(std::find(slabs_.begin(), slabs_.end(), slab));
+    operator delete(slab, std::align_val_t(kSlabSize));
+    --stats_.slabs;
+    ++stats_.slab_releases;
+    stats_.capacity -= kSlabSlots;
+  }
+
+  void trim() {
+    while (tail_ && tail_->live == 0 && stats_.slabs > 1 &&
+        2 * stats_.live < stats_.capacity - kSlabSlots) {
+      release(tail_);
+    }
+  }
+
+public:
+  HandleArena() = default;
+  HandleArena(const HandleArena&) = delete;
+  auto operator=(const HandleArena&) -> HandleArena& = delete;
+
+  ~HandleArena() {
+    for (auto slab: slabs_) operator delete(slab, std::align_val_t(kSlabSize));
+  }
+
+  auto stats() const -> HandleStats {
+    return stats_;
+  }
+
+  // Whether a handle was made by this arena. Only reads the arena itself,
+  // so it is safe for handles of other stores on other threads.
+  auto owns(const Handle* handle) const -> bool {
+    auto slab = slab_of(reinterpret_cast<Slot*>(const_cast<Handle*>(handle)));
+    return std::find(slabs_.begin(), slabs_.end(), slab) != slabs_.end();
+  }
+
+  auto make() -> Handle* {
+    if (!head_ && !grow()) return nullptr;
+    auto slab = head_;
+    auto slot = slab->free;
+    slab->free = slot->next;
+    if (!slab->free) unlink(slab);
+    ++slab->live;
+    if (++stats_.live > stats_.high_water) stats_.high_water = stats_.live;
+    return new(slot->handle) Handle();
+  }
+
+  // The handle must have been reset.
+  void free(Handle* handle) {
+    handle->~Handle();
+    auto slot = reinterpret_cast<Slot*>(handle);
+    auto slab = slab_of(slot);
+    if (!slab->free) link_front(slab);
+    slot->next = slab->free;
+    slab->free = slot;
+    --stats_.live;
+    if (--slab->live == 0 && slab != tail_) {
+      unlink(slab);
+      link_back(slab);
+    }
+    trim();
+  }
+};
+
 struct StoreImpl : Store {
   friend own<Store> Store::make(Engine*);
 
@@ -322,10 +707,58 @@ struct StoreImpl : Store {
   v8::Eternal<v8::Context> context_;
   v8::Eternal<v8::String> strings_[V8_S_COUNT];
   v8::Eternal<v8::Symbol> symbols_[V8_Y_COUNT];
+  v8::Eternal<v8::Private> privates_[V8_P_COUNT];
   v8::Eternal<v8::Function> functions_[V8_F_COUNT];
-  v8::Eternal<v8::Object> host_data_map_;
   v8::Eternal<v8::Symbol> callback_symbol_;
-  std::stack<v8::Persistent<v8::Object>*> handle_pool_; 
+  HandleArena handles_;
+
+  // Import and export names are internalized once per module, see
+  // module_names, and live as long as their module.
+  size_t names_created_ = 0;
+
+  // Host info of references, keyed by the identity hash of their object.
+  // Open addressing with linear probing and backward shift deletion. Entries
+  // hold their object weakly and stay until finalized after its collection,
+  // or until the store goes away. Besides the user's host info, an entry
+  // keeps the data of host functions, which users cannot replace.
+  enum HostInfoSlot { HOST_INFO_USER, HOST_INFO_FUNC_DATA, HOST_INFO_COUNT };
+  struct HostInfo {
+    StoreImpl* store;
+    v8::Global<v8::Object> object;
+    uint32_t hash;
+    struct {
+      void* info;
+      void (*finalizer)(void*);
+    } slots[HOST_INFO_COUNT];
+  };
+  std::vector<std::unique_ptr<HostInfo>> host_infos_;
+  size_t host_infos_count_ = 0;
+
+  // Host info finalizers of collected objects, queued instead of run while
+  // finalizers are deferred. Entries before the head have already run.
+  struct PendingFinalizer {
+    void (*finalizer)(void*);
+    void* info;
+  };
+  bool defer_finalizers_ = false;
+  std::vector<PendingFinalizer> pending_finalizers_;
+  size_t pending_head_ = 0;
+
+  // Memories that handed out views, with their data as last seen. Handles
+  // are weak and become empty once a memory is collected.
+  struct WatchedMemory {
+    v8::Global<v8::Object> memory;
+    byte_t* base;
+    size_t size;
+  };
+  std::vector<WatchedMemory> watched_memories_;
+  uint64_t memory_generation_ = 0;
+  std::vector<std::unique_ptr<DirtyTracker>> dirty_trackers_;
+
+  // Cost and outcome of the last full collection, to judge idle time by.
+  std::chrono::steady_clock::duration full_gc_time_ =
+    std::chrono::milliseconds(10);
+  size_t used_after_full_gc_ = 0;
 
   StoreImpl() {
     stats.make(Stats::STORE, this);
@@ -338,15 +771,25 @@ struct StoreImpl : Store {
 #endif
     {
       v8::HandleScope scope(isolate_);
-      while (handle_pool_.empty()) {
-        auto handle = handle_pool_.top();
-        delete handle;
-        handle_pool_.pop();
+      for (auto& entry : host_infos_) {
+        if (entry) entry->object.Reset();
       }
+      watched_memories_.clear();
+      dirty_trackers_.clear();
     }
     context()->Exit();
     isolate_->Exit();
     isolate_->Dispose();
+    for (auto i = pending_head_; i < pending_finalizers_.size(); ++i) {
+      auto pending = pending_finalizers_[i];
+      pending.finalizer(pending.info);
+    }
+    for (auto& entry : host_infos_) {
+      if (!entry) continue;
+      for (auto& slot : entry->slots) {
+        if (slot.finalizer) slot.finalizer(slot.info);
+      }
+    }
     delete create_params_.array_buffer_allocator;
     stats.free(Stats::STORE, this);
   }
@@ -355,6 +798,27 @@ struct StoreImpl : Store {
     return isolate_;
   }
 
+  auto allocator() const -> StoreAllocator* {
+    return static_cast<StoreAllocator*>(create_params_.array_buffer_allocator);
+  }
+
+  // Under the huge page allocator, advises the kernel to back a Wasm memory
+  // with transparent huge pages, up to its maximum size, so that growing is
+  // covered. Best effort: the engine may have reserved less. The advised
+  // range is counted, not the pages the kernel actually backs.
+  void advise_huge_pages(v8::Local<v8::Object> memory) {
+#ifdef __linux__
+    if (allocator()->kind() != AllocatorKind::HUGE_PAGE) return;
+    auto max_pages = std::min<size_t>(wasm_v8::memory_type_max(memory), 0x10000);
+    auto size = max_pages * Memory::page_size;
+    auto data = wasm_v8::memory_data(memory);
+    if (data && size > 0) {
+      madvise(data, size, MADV_HUGEPAGE);
+      allocator()->count_advised_huge_pages(size);
+    }
+#endif
+  }
+
   auto context() const -> v8::Local<v8::Context> {
     return context_.Get(isolate_);
   }
@@ -365,12 +829,261 @@ struct StoreImpl : Store {
   auto v8_string(v8_symbol_t i) const -> v8::Local<v8::Symbol> {
     return symbols_[i].Get(isolate_);
   }
+  auto v8_private(v8_private_t i) const -> v8::Local<v8::Private> {
+    return privates_[i].Get(isolate_);
+  }
   auto v8_function(v8_function_t i) const -> v8::Local<v8::Function> {
     return functions_[i].Get(isolate_);
   }
 
-  auto host_data_map() const -> v8::Local<v8::Object> {
-    return host_data_map_.Get(isolate_);
+  auto names_created() const -> size_t {
+    return names_created_;
+  }
+  void count_names(size_t n) {
+    names_created_ += n;
+  }
+
+  auto memory_generation() const -> uint64_t {
+    return memory_generation_;
+  }
+
+  void watch_memory(v8::Local<v8::Object> memory, byte_t* base, size_t size) {
+    for (auto& watched : watched_memories_) {
+      if (watched.memory != memory) continue;
+      if (watched.base != base || watched.size != size) {
+        watched.base = base;
+        watched.size = size;
+        ++memory_generation_;
+      }
+      return;
+    }
+    watched_memories_.erase(std::remove_if(
+      watched_memories_.begin(), watched_memories_.end(),
+      [](const WatchedMemory& watched) { return watched.memory.IsEmpty(); }),
+      watched_memories_.end());
+    watched_memories_.emplace_back();
+    auto& watched = watched_memories_.back();
+    watched.memory.Reset(isolate_, memory);
+    watched.memory.SetWeak();
+    watched.base = base;
+    watched.size = size;
+  }
+
+  auto dirty_tracker(v8::Local<v8::Object> memory, bool create)
+  -> DirtyTracker* {
+    for (auto& tracker : dirty_trackers_) {
+      if (tracker->memory == memory) return tracker.get();
+    }
+    if (!create) return nullptr;
+    dirty_trackers_.erase(std::remove_if(
+      dirty_trackers_.begin(), dirty_trackers_.end(),
+      [](const std::unique_ptr<DirtyTracker>& tracker) {
+        return tracker->memory.IsEmpty();
+      }), dirty_trackers_.end());
+    auto tracker = std::unique_ptr<DirtyTracker>(
+      new(std::nothrow) DirtyTracker());
+    if (!tracker) return nullptr;
+    tracker->memory.Reset(isolate_, memory);
+    tracker->memory.SetWeak();
+    tracker->store = this;
+    dirty_trackers_.push_back(std::move(tracker));
+    return dirty_trackers_.back().get();
+  }
+
+  // Called whenever Wasm code may have grown a memory, including on every
+  // host callback, so this only loads each memory's extent through its
+  // handle. Collected memories are dropped when the next one is watched.
+  void refresh_memories() {
+    for (auto& watched : watched_memories_) {
+      if (watched.memory.IsEmpty()) continue;
+      char* base;
+      size_t size;
+      wasm_v8::memory_extent(watched.memory, &base, &size);
+      if (watched.base != base || watched.size != size) {
+        watched.base = base;
+        watched.size = size;
+        ++memory_generation_;
+      }
+    }
+  }
+
+  auto host_info(
+    v8::Local<v8::Object> obj, HostInfoSlot slot = HOST_INFO_USER
+  ) -> void* {
+    if (host_infos_count_ == 0) return nullptr;
+    auto i = find_host_info(obj, obj->GetIdentityHash());
+    return host_infos_[i] ? host_infos_[i]->slots[slot].info : nullptr;
+  }
+
+  // Replacing host info finalizes the previous one right away.
+  auto set_host_info(
+    v8::Local<v8::Object> obj, void* info, void (*finalizer)(void*),
+    HostInfoSlot slot = HOST_INFO_USER
+  ) -> bool {
+    auto hash = static_cast<uint32_t>(obj->GetIdentityHash());
+    if (4 * (host_infos_count_ + 1) > 3 * host_infos_.size()) {
+      grow_host_infos();
+    }
+    auto i = find_host_info(obj, hash);
+    auto& entry = host_infos_[i];
+    if (entry) {
+      auto& old = entry->slots[slot];
+      if (old.finalizer) old.finalizer(old.info);
+      old.info = info;
+      old.finalizer = finalizer;
+      return true;
+    }
+    entry.reset(new(std::nothrow) HostInfo{this, {}, hash, {}});
+    if (!entry) return false;
+    entry->slots[slot].info = info;
+    entry->slots[slot].finalizer = finalizer;
+    entry->object.Reset(isolate_, obj);
+    entry->object.SetWeak(
+      entry.get(), &collect_host_info, v8::WeakCallbackType::kParameter);
+    ++host_infos_count_;
+    return true;
+  }
+
+  // Index of the entry for an object, or of the free slot ending its probe.
+  auto find_host_info(v8::Local<v8::Object> obj, uint32_t hash) -> size_t {
+    auto mask = host_infos_.size() - 1;
+    auto i = hash & mask;
+    for (; host_infos_[i]; i = (i + 1) & mask) {
+      auto& entry = host_infos_[i];
+      if (entry->hash == hash && entry->object == obj) break;
+    }
+    return i;
+  }
+
+  void grow_host_infos() {
+    auto old_infos = std::move(host_infos_);
+    host_infos_ = std::vector<std::unique_ptr<HostInfo>>(
+      old_infos.empty() ? 64 : 2 * old_infos.size());
+    auto mask = host_infos_.size() - 1;
+    for (auto& entry : old_infos) {
+      if (!entry) continue;
+      auto i = entry->hash & mask;
+      while (host_infos_[i]) i = (i + 1) & mask;
+      host_infos_[i] = std::move(entry);
+    }
+  }
+
+  auto take_host_info(HostInfo* entry) -> std::unique_ptr<HostInfo> {
+    auto mask = host_infos_.size() - 1;
+    auto i = entry->hash & mask;
+    while (host_infos_[i].get() != entry) i = (i + 1) & mask;
+    auto taken = std::move(host_infos_[i]);
+    // Shift back later entries of the probe that could not use the slot.
+    for (auto j = (i + 1) & mask; host_infos_[j]; j = (j + 1) & mask) {
+      auto home = host_infos_[j]->hash & mask;
+      if (((j - home) & mask) >= ((j - i) & mask)) {
+        host_infos_[i] = std::move(host_infos_[j]);
+        i = j;
+      }
+    }
+    --host_infos_count_;
+    return taken;
+  }
+
+  // Finalizers run in a second pass, when they may use the API again.
+  static void collect_host_info(const v8::WeakCallbackInfo<HostInfo>& info) {
+    auto entry = info.GetParameter();
+    entry->object.Reset();
+    for (auto& slot : entry->slots) {
+      if (slot.finalizer) {
+        info.SetSecondPassCallback(&finalize_host_info);
+        return;
+      }
+    }
+    entry->store->take_host_info(entry);
+  }
+
+  static void finalize_host_info(const v8::WeakCallbackInfo<HostInfo>& info) {
+    auto store = info.GetParameter()->store;
+    auto entry = store->take_host_info(info.GetParameter());
+    for (auto& slot : entry->slots) {
+      if (!slot.finalizer) continue;
+      if (store->defer_finalizers_) {
+        store->pending_finalizers_.push_back({slot.finalizer, slot.info});
+      } else {
+        slot.finalizer(slot.info);
+      }
+    }
+  }
+
+  void set_deferred_finalizers(bool defer) {
+    defer_finalizers_ = defer;
+  }
+
+  // Finalizers may cause collections that queue more, so entries are copied
+  // out before running.
+  auto run_pending_finalizers(size_t budget) -> size_t {
+    for (; budget > 0 && pending_head_ < pending_finalizers_.size(); --budget) {
+      auto pending = pending_finalizers_[pending_head_++];
+      pending.finalizer(pending.info);
+    }
+    // Drop the consumed prefix once it is half the queue, so that small
+    // budgets under a steady inflow do not grow it without bound.
+    if (2 * pending_head_ >= pending_finalizers_.size()) {
+      pending_finalizers_.erase(pending_finalizers_.begin(),
+        pending_finalizers_.begin() + pending_head_);
+      pending_head_ = 0;
+    }
+    return pending_finalizers_.size() - pending_head_;
+  }
+
+  auto heap_stats() const -> HeapStats {
+    v8::HeapStatistics heap;
+    isolate_->GetHeapStatistics(&heap);
+    v8::HeapCodeStatistics code;
+    isolate_->GetHeapCodeAndMetadataStatistics(&code);
+    return {
+      heap.used_heap_size(), heap.total_heap_size(), heap.heap_size_limit(),
+      heap.external_memory(),
+      code.code_and_metadata_size() + code.bytecode_and_metadata_size()
+    };
+  }
+
+  void notify_memory_pressure(MemoryPressure pressure) {
+    auto level = v8::MemoryPressureLevel::kNone;
+    switch (pressure) {
+      case MemoryPressure::NONE: level = v8::MemoryPressureLevel::kNone; break;
+      case MemoryPressure::MODERATE:
+        level = v8::MemoryPressureLevel::kModerate; break;
+      case MemoryPressure::CRITICAL:
+        level = v8::MemoryPressureLevel::kCritical; break;
+    }
+    isolate_->MemoryPressureNotification(level);
+  }
+
+  // Forced collections process weak callbacks, and thus host info
+  // finalizers, synchronously.
+  void collect(CollectionKind kind) {
+    if (kind == CollectionKind::MINOR) {
+      isolate_->RequestGarbageCollectionForTesting(
+        v8::Isolate::kMinorGarbageCollection);
+      return;
+    }
+    auto start = std::chrono::steady_clock::now();
+    isolate_->RequestGarbageCollectionForTesting(
+      v8::Isolate::kFullGarbageCollection);
+    full_gc_time_ = std::chrono::steady_clock::now() - start;
+    used_after_full_gc_ = heap_stats().used_bytes;
+  }
+
+  // Scavenges, then collects fully if the heap grew since the last full
+  // collection and that took less than the remaining budget.
+  auto idle_notification(uint32_t budget_ms) -> bool {
+    auto deadline =
+      std::chrono::steady_clock::now() + std::chrono::milliseconds(budget_ms);
+    if (heap_stats().used_bytes <= used_after_full_gc_) return true;
+    if (budget_ms == 0) return false;
+    collect(CollectionKind::MINOR);
+    if (std::chrono::steady_clock::now() + full_gc_time_ > deadline) {
+      return false;
+    }
+    collect(CollectionKind::FULL);
+    return true;
   }
 
   static auto get(v8::Isolate* isolate) -> StoreImpl* {
@@ -378,22 +1091,20 @@ struct StoreImpl : Store {
   }
 
   auto make_handle() -> v8::Persistent<v8::Object>* {
-    if (handle_pool_.empty()) {
-      static const size_t n = 100;
-      for (size_t i = 0; i < n; ++i) {
-        auto handle = new(std::nothrow) v8::Persistent<v8::Object>();
-        if (!handle) return nullptr;
-        handle_pool_.push(handle);
-      }
-    }
-    auto handle = handle_pool_.top();
-    handle_pool_.pop();
-    return handle;
+    return handles_.make();
   }
 
   void free_handle(v8::Persistent<v8::Object>* handle) {
-    // TODO: shrink pool?
-    handle->Reset(isolate_, v8::Local<v8::Object>());
+    handle->Reset();
+    handles_.free(handle);
+  }
+
+  auto handle_stats() const -> HandleStats {
+    return handles_.stats();
+  }
+
+  auto owns_handle(const v8::Persistent<v8::Object>* handle) const -> bool {
+    return handles_.owns(handle);
   }
 };
 
@@ -404,13 +1115,55 @@ void Store::destroy() {
   delete impl(this);
 }
 
-auto Store::make(Engine*) -> own<Store> {
+auto Store::memory_generation() const -> uint64_t {
+  return impl(this)->memory_generation();
+}
+
+auto Store::allocator_stats() const -> AllocatorStats {
+  return impl(this)->allocator()->stats();
+}
+
+auto Store::handle_stats() const -> HandleStats {
+  return impl(this)->handle_stats();
+}
+
+auto Store::names_created() const -> size_t {
+  return impl(this)->names_created();
+}
+
+auto Store::heap_stats() const -> HeapStats {
+  return impl(this)->heap_stats();
+}
+
+void Store::notify_memory_pressure(MemoryPressure pressure) {
+  impl(this)->notify_memory_pressure(pressure);
+}
+
+auto Store::idle_notification(uint32_t budget_ms) -> bool {
+  return impl(this)->idle_notification(budget_ms);
+}
+
+void Store::collect(CollectionKind kind) {
+  impl(this)->collect(kind);
+}
+
+void Store::set_deferred_finalizers(bool defer) {
+  impl(this)->set_deferred_finalizers(defer);
+}
+
+auto Store::run_pending_finalizers(size_t budget) -> size_t {
+  return impl(this)->run_pending_finalizers(budget);
+}
+
+auto Store::make(Engine* engine_abs) -> own<Store> {
+  auto engine = impl(engine_abs);
   auto store = own<StoreImpl>(new(std::nothrow) StoreImpl());
   if (!store) return own<Store>();
 
   // Create isolate.
-  store->create_params_.array_buffer_allocator =
-    v8::ArrayBuffer::Allocator::NewDefaultAllocator();
+  store->create_params_.array_buffer_allocator = new(std::nothrow)
+    StoreAllocator(engine->allocator_kind, engine->allocator_callbacks);
+  if (!store->create_params_.array_buffer_allocator) return own<Store>();
   auto isolate = v8::Isolate::New(store->create_params_);
   if (!isolate) return own<Store>();
 
@@ -431,7 +1184,7 @@ auto Store::make(Engine*) -> own<Store> {
       "",
       "i32", "i64", "f32", "f64", "externref", "funcref",
       "value", "mutable", "element", "initial", "maximum",
-      "anyfunc"
+      "anyfunc", "shared", "index"
     };
     for (int i = 0; i < V8_S_COUNT; ++i) {
       auto maybe = v8::String::NewFromUtf8(isolate, raw_strings[i],
@@ -446,6 +1199,11 @@ auto Store::make(Engine*) -> own<Store> {
       store->symbols_[i] = v8::Eternal<v8::Symbol>(isolate, symbol);
     }
 
+    for (int i = 0; i < V8_P_COUNT; ++i) {
+      auto key = v8::Private::New(isolate);
+      store->privates_[i] = v8::Eternal<v8::Private>(isolate, key);
+    }
+
     // Extract functions.
     auto global = context->Global();
     auto maybe_wasm_name = v8::String::NewFromUtf8(isolate, "WebAssembly",
@@ -455,15 +1213,11 @@ auto Store::make(Engine*) -> own<Store> {
     auto maybe_wasm = global->Get(context, wasm_name);
     if (maybe_wasm.IsEmpty()) return own<Store>();
     auto wasm = v8::Local<v8::Object>::Cast(maybe_wasm.ToLocalChecked());
-    v8::Local<v8::Object> weakmap;
-    v8::Local<v8::Object> weakmap_proto;
 
     struct {
       const char* name;
       v8::Local<v8::Object>* carrier;
     } raw_functions[V8_F_COUNT] = {
-      {"WeakMap", &global}, {"prototype", &weakmap},
-      {"get", &weakmap_proto}, {"set", &weakmap_proto},
       {"Module", &wasm}, {"Global", &wasm}, {"Table", &wasm}, {"Memory", &wasm},
       {"Instance", &wasm}, {"validate", &wasm},
     };
@@ -478,25 +1232,10 @@ auto Store::make(Engine*) -> own<Store> {
       auto maybe_obj = (*raw_functions[i].carrier)->Get(context, name);
       if (maybe_obj.IsEmpty()) return own<Store>();
       auto obj = v8::Local<v8::Object>::Cast(maybe_obj.ToLocalChecked());
-      if (i == V8_F_WEAKMAP_PROTO) {
-        assert(obj->IsObject());
-        weakmap_proto = obj;
-      } else {
-        assert(obj->IsFunction());
-        auto function = v8::Local<v8::Function>::Cast(obj);
-        store->functions_[i] = v8::Eternal<v8::Function>(isolate, function);
-        if (i == V8_F_WEAKMAP) weakmap = function;
-      }
+      assert(obj->IsFunction());
+      auto function = v8::Local<v8::Function>::Cast(obj);
+      store->functions_[i] = v8::Eternal<v8::Function>(isolate, function);
     }
-
-    // Create host data weak map.
-    v8::Local<v8::Value> empty_args[] = {};
-    auto maybe_weakmap =
-      store->v8_function(V8_F_WEAKMAP)->NewInstance(context, 0, empty_args);
-    if (maybe_weakmap.IsEmpty()) return own<Store>();
-    auto map = v8::Local<v8::Object>::Cast(maybe_weakmap.ToLocalChecked());
-    assert(map->IsWeakMap());
-    store->host_data_map_ = v8::Eternal<v8::Object>(isolate, map);
   }
 
   store->isolate()->Enter();
@@ -775,10 +1514,12 @@ auto ExternType::table() const -> const TableType* {
 
 struct MemoryTypeImpl : ExternTypeImpl<MemoryType> {
   Limits limits;
+  bool shared;
+  bool is64;
 
-  MemoryTypeImpl(Limits limits) :
+  MemoryTypeImpl(Limits limits, bool shared, bool is64) :
     ExternTypeImpl(ExternKind::MEMORY),
-    limits(limits)
+    limits(limits), shared(shared), is64(is64)
   {
     stats.make(Stats::MEMORYTYPE, this);
   }
@@ -795,18 +1536,29 @@ void MemoryType::destroy() {
   delete impl(this);
 }
 
-auto MemoryType::make(Limits limits) -> own<MemoryType> {
-  return own<MemoryType>(new(std::nothrow) MemoryTypeImpl(limits));
+auto MemoryType::make(
+  Limits limits, bool shared, bool is64
+) -> own<MemoryType> {
+  return own<MemoryType>(
+    new(std::nothrow) MemoryTypeImpl(limits, shared, is64));
 }
 
 auto MemoryType::copy() const -> own<MemoryType> {
-  return MemoryType::make(limits());
+  return MemoryType::make(limits(), shared(), is64());
 }
 
 auto MemoryType::limits() const -> const Limits& {
   return impl(this)->limits;
 }
 
+auto MemoryType::shared() const -> bool {
+  return impl(this)->shared;
+}
+
+auto MemoryType::is64() const -> bool {
+  return impl(this)->is64;
+}
+
 
 auto ExternType::memory() -> MemoryType* {
   return kind() == ExternKind::MEMORY
@@ -996,6 +1748,14 @@ auto memorytype_to_v8(
   auto isolate = store->isolate();
   auto desc = v8::Object::New(isolate);
   limits_to_v8(store, type->limits(), desc);
+  if (type->shared()) {
+    ignore(desc->DefineOwnProperty(store->context(),
+      store->v8_string(V8_S_SHARED), v8::True(isolate)));
+  }
+  if (type->is64()) {
+    ignore(desc->DefineOwnProperty(store->context(),
+      store->v8_string(V8_S_INDEX), store->v8_string(V8_S_I64)));
+  }
   return desc;
 }
 
@@ -1043,23 +1803,12 @@ struct RefImpl : Ref, v8::Persistent<v8::Object> {
 
   auto get_host_info() const -> void* {
     v8::HandleScope handle_scope(isolate());
-    auto store = this->store();
-
-    v8::Local<v8::Value> args[] = { v8_object() };
-    auto maybe_result = store->v8_function(V8_F_WEAKMAP_GET)->Call(
-      store->context(), store->host_data_map(), 1, args);
-    if (maybe_result.IsEmpty()) return nullptr;
-    return wasm_v8::managed_get(maybe_result.ToLocalChecked());
+    return store()->host_info(v8_object());
   }
 
   void set_host_info(void* info, void (*finalizer)(void*)) {
     v8::HandleScope handle_scope(isolate());
-    auto store = this->store();
-    auto managed = wasm_v8::managed_new(store->isolate(), info, finalizer);
-    v8::Local<v8::Value> args[] = { v8_object(), managed };
-    auto maybe_result = store->v8_function(V8_F_WEAKMAP_SET)->Call(
-      store->context(), store->host_data_map(), 2, args);
-    if (maybe_result.IsEmpty()) return;
+    ignore(store()->set_host_info(v8_object(), info, finalizer));
   }
 };
 
@@ -1134,10 +1883,10 @@ auto v8_to_ref(StoreImpl* store, v8::Local<v8::Value> value) -> own<Ref> {
 }
 
 auto v8_to_val(
-  StoreImpl* store, v8::Local<v8::Value> value, const ValType* t
+  StoreImpl* store, v8::Local<v8::Value> value, ValKind kind
 ) -> Val {
   auto context = store->context();
-  switch (t->kind()) {
+  switch (kind) {
     case ValKind::I32: return Val(value->Int32Value(context).ToChecked());
     case ValKind::I64: {
       auto bigint = value->ToBigInt(context).ToLocalChecked();
@@ -1155,6 +1904,12 @@ auto v8_to_val(
   }
 }
 
+auto v8_to_val(
+  StoreImpl* store, v8::Local<v8::Value> value, const ValType* t
+) -> Val {
+  return v8_to_val(store, value, t->kind());
+}
+
 
 ///////////////////////////////////////////////////////////////////////////////
 // Runtime Objects
@@ -1328,89 +2083,139 @@ auto Module::make(Store* store_abs, const vec<byte_t>& binary) -> own<Module> {
   return RefImpl<Module>::make(store, maybe_obj.ToLocalChecked());
 }
 
-auto Module::imports() const -> ownvec<ImportType> {
-  v8::HandleScope handle_scope(impl(this)->isolate());
-  auto module = impl(this)->v8_object();
+// Module metadata is decoded once per module object and attached to it
+// through a private property. Names borrow from the module's wire bytes,
+// which stay alive as long as the module object does. The function and
+// export name indices are only built on first use.
+
+struct ModuleData {
+  bin::SectionIndex index;
+  bin::ModuleInfo info;
+  bool has_func_names = false;
+  std::vector<ByteSpan> func_names;
+  bool has_export_names = false;
+  std::vector<uint32_t> export_names;  // export indices sorted by name
+
+  static void finalize(void* data) {
+    delete reinterpret_cast<ModuleData*>(data);
+  }
+};
+
+auto module_data(
+  StoreImpl* store, v8::Local<v8::Object> module
+) -> ModuleData* {
+  auto context = store->context();
+  auto key = store->v8_private(V8_P_MODULE_DATA);
+  auto maybe_managed = module->GetPrivate(context, key);
+  if (!maybe_managed.IsEmpty()) {
+    auto data = wasm_v8::managed_get(maybe_managed.ToLocalChecked());
+    if (data) return reinterpret_cast<ModuleData*>(data);
+  }
+
   auto binary = vec<byte_t>::adopt(
     wasm_v8::module_binary_size(module),
     const_cast<byte_t*>(wasm_v8::module_binary(module))
   );
-  auto imports = wasm::bin::imports(binary);
+  auto data = new(std::nothrow) ModuleData;
+  if (data) {
+    data->index = bin::section_index(binary);
+    data->info = bin::module_info(data->index);
+  }
   binary.release();
-  return imports;
-  // return impl(this)->data->imports.copy();
-/* OBSOLETE?
-  auto store = module->store();
+  if (!data) return nullptr;
+  auto managed =
+    wasm_v8::managed_new(store->isolate(), data, &ModuleData::finalize);
+  ignore(module->SetPrivate(context, key, managed));
+  return data;
+}
+
+// Import and export names of a module as internalized strings, created on
+// first use and held by the module object, so that they go away with it.
+// Imports come first, as pairs of module and name, followed by exports.
+auto module_names(
+  StoreImpl* store, v8::Local<v8::Object> module, const ModuleData* data
+) -> v8::MaybeLocal<v8::Array> {
   auto isolate = store->isolate();
   auto context = store->context();
-  v8::HandleScope handle_scope(isolate);
-
-  v8::Local<v8::Value> args[] = { module->v8_object() };
-  auto result = store->v8_function(V8_F_IMPORTS)->Call(
-    context, v8::Undefined(isolate), 1, args);
-  if (result.IsEmpty()) return wasm_importtype_vec_empty();
-  auto array = v8::Local<v8::Array>::Cast(result.ToLocalChecked());
-  size_t size = array->Length();
+  auto key = store->v8_private(V8_P_MODULE_NAMES);
+  v8::Local<v8::Value> value;
+  if (module->GetPrivate(context, key).ToLocal(&value) && value->IsArray()) {
+    return v8::Local<v8::Array>::Cast(value);
+  }
 
-  wasm_importtype_vec_t imports = wasm_importtype_vec_new_uninitialized(size);
-  for (size_t i = 0; i < size; ++i) {
-    auto desc = v8::Local<v8::Object>::Cast(array->Get(i));
-    auto module_str = v8::Local<v8::String>::Cast(
-      desc->Get(context, store->v8_string(V8_S_MODULE)).ToLocalChecked());
-    auto name_str = v8::Local<v8::String>::Cast(
-      desc->Get(context, store->v8_string(V8_S_NAME)).ToLocalChecked());
-    auto kind_str = v8::Local<v8::String>::Cast(
-      desc->Get(context, store->v8_string(V8_S_KIND)).ToLocalChecked());
+  auto& imports = data->info.imports;
+  auto& exports = data->info.exports;
+  auto n = 2 * imports.size() + exports.size();
+  auto names = v8::Array::New(isolate, static_cast<int>(n));
+  auto set = [&](size_t i, const bin::Span& name) -> bool {
+    v8::Local<v8::String> string;
+    return v8::String::NewFromUtf8(isolate, name.data,
+        v8::NewStringType::kInternalized, static_cast<int>(name.size)
+      ).ToLocal(&string) &&
+      names->Set(context, static_cast<uint32_t>(i), string).FromMaybe(false);
+  };
+  for (size_t i = 0; i < imports.size(); ++i) {
+    if (!set(2 * i, imports[i].module) || !set(2 * i + 1, imports[i].name)) {
+      return v8::MaybeLocal<v8::Array>();
+    }
+  }
+  for (size_t i = 0; i < exports.size(); ++i) {
+    if (!set(2 * imports.size() + i, exports[i].name)) {
+      return v8::MaybeLocal<v8::Array>();
+    }
+  }
+  if (!module->SetPrivate(context, key, names).FromMaybe(false)) {
+    return v8::MaybeLocal<v8::Array>();
+  }
+  store->count_names(n);
+  return names;
+}
 
-    auto type = wasm_externtype_new_from_v8_kind(store, kind_str);
-    auto module = wasm_byte_vec_new_from_v8_string(module_str);
-    auto name = wasm_byte_vec_new_from_v8_string(name_str);
-    imports.data[i] = wasm_importtype_new(module, name, type);
+auto module_name(
+  StoreImpl* store, v8::Local<v8::Array> names, size_t i
+) -> v8::MaybeLocal<v8::String> {
+  v8::Local<v8::Value> value;
+  if (!names->Get(store->context(), static_cast<uint32_t>(i)).ToLocal(&value) ||
+      !value->IsString()) {
+    return v8::MaybeLocal<v8::String>();
   }
+  return v8::Local<v8::String>::Cast(value);
+}
 
-  return imports;
-*/
+auto Module::imports() const -> ownvec<ImportType> {
+  v8::HandleScope handle_scope(impl(this)->isolate());
+  auto data = module_data(impl(this)->store(), impl(this)->v8_object());
+  if (!data) return ownvec<ImportType>::invalid();
+  return wasm::bin::imports(data->info);
 }
 
 auto Module::exports() const -> ownvec<ExportType> {
   v8::HandleScope handle_scope(impl(this)->isolate());
-  auto module = impl(this)->v8_object();
-  auto binary = vec<byte_t>::adopt(
-    wasm_v8::module_binary_size(module),
-    const_cast<byte_t*>(wasm_v8::module_binary(module))
-  );
-  auto exports = wasm::bin::exports(binary);
-  binary.release();
-  return exports;
-  // return impl(this)->data->exports.copy();
-/* OBSOLETE?
-  auto store = module->store();
-  auto isolate = store->isolate();
-  auto context = store->context();
-  v8::HandleScope handle_scope(isolate);
-
-  v8::Local<v8::Value> args[] = { module->v8_object() };
-  auto result = store->v8_function(V8_F_EXPORTS)->Call(
-    context, v8::Undefined(isolate), 1, args);
-  if (result.IsEmpty()) return wasm_exporttype_vec_empty();
-  auto array = v8::Local<v8::Array>::Cast(result.ToLocalChecked());
-  size_t size = array->Length();
+  auto data = module_data(impl(this)->store(), impl(this)->v8_object());
+  if (!data) return ownvec<ExportType>::invalid();
+  return wasm::bin::exports(data->info);
+}
 
-  wasm_exporttype_vec_t exports = wasm_exporttype_vec_new_uninitialized(size);
-  for (size_t i = 0; i < size; ++i) {
-    auto desc = v8::Local<v8::Object>::Cast(array->Get(i));
-    auto name_str = v8::Local<v8::String>::Cast(
-      desc->Get(context, store->v8_string(V8_S_NAME)).ToLocalChecked());
-    auto kind_str = v8::Local<v8::String>::Cast(
-      desc->Get(context, store->v8_string(V8_S_KIND)).ToLocalChecked());
+auto Module::custom_sections() const -> vec<CustomSection> {
+  v8::HandleScope handle_scope(impl(this)->isolate());
+  auto data = module_data(impl(this)->store(), impl(this)->v8_object());
+  if (!data) return vec<CustomSection>::invalid();
+  auto& customs = data->index.customs;
+  auto sections = vec<CustomSection>::make_uninitialized(customs.size());
+  for (size_t i = 0; i < sections.size(); ++i) sections[i] = customs[i];
+  return sections;
+}
 
-    auto type = wasm_externtype_new_from_v8_kind(store, kind_str);
-    auto name = wasm_byte_vec_new_from_v8_string(name_str);
-    exports.data[i] = wasm_exporttype_new(name, type);
+auto Module::func_name(uint32_t index) const -> ByteSpan {
+  v8::HandleScope handle_scope(impl(this)->isolate());
+  auto data = module_data(impl(this)->store(), impl(this)->v8_object());
+  if (!data) return ByteSpan{nullptr, 0};
+  if (!data->has_func_names) {
+    data->func_names = bin::func_names(data->index, data->info);
+    data->has_func_names = true;
   }
-
-  return exports;
-*/
+  if (index >= data->func_names.size()) return ByteSpan{nullptr, 0};
+  return data->func_names[index];
 }
 
 auto Module::serialize() const -> vec<byte_t> {
@@ -1628,7 +2433,8 @@ auto make_func(Store* store_abs, FuncData* data) -> own<Func> {
   assert(wrapped_func_obj->IsFunction());
 
   auto func = RefImpl<Func>::make(store, wrapped_func_obj);
-  func->set_host_info(data, &FuncData::finalize_func_data);
+  ignore(store->set_host_info(wrapped_func_obj, data,
+    &FuncData::finalize_func_data, StoreImpl::HOST_INFO_FUNC_DATA));
   return func;
 }
 
@@ -1688,29 +2494,31 @@ auto Func::result_arity() const -> size_t {
   return wasm_v8::func_type_result_arity(impl(this)->v8_object());
 }
 
-auto Func::call(const vec<Val>& args, vec<Val>& results) const -> own<Trap> {
-  auto func = impl(this);
-  auto store = func->store();
+// Parameter and result kinds are read from the function's signature
+// directly, without building a FuncType.
+auto call_function(
+  StoreImpl* store, v8::Local<v8::Object> v8_func,
+  const vec<Val>& args, vec<Val>& results
+) -> own<Trap> {
   auto isolate = store->isolate();
-  v8::HandleScope handle_scope(isolate);
-
   auto context = store->context();
-  auto type = this->type();
-  auto& param_types = type->params();
-  auto& result_types = type->results();
+  auto param_arity = wasm_v8::func_type_param_arity(v8_func);
+  auto result_arity = wasm_v8::func_type_result_arity(v8_func);
 
   // TODO: cache v8_args array per thread.
   auto v8_args = std::unique_ptr<v8::Local<v8::Value>[]>(
-    new(std::nothrow) v8::Local<v8::Value>[param_types.size()]);
-  for (size_t i = 0; i < param_types.size(); ++i) {
-    assert(args[i].kind() == param_types[i]->kind());
+    new(std::nothrow) v8::Local<v8::Value>[param_arity]);
+  for (size_t i = 0; i < param_arity; ++i) {
+    assert(args[i].kind() ==
+      static_cast<ValKind>(wasm_v8::func_type_param(v8_func, i)));
     v8_args[i] = val_to_v8(store, args[i]);
   }
 
   v8::TryCatch handler(isolate);
-  auto v8_function = v8::Local<v8::Function>::Cast(func->v8_object());
+  auto v8_function = v8::Local<v8::Function>::Cast(v8_func);
   auto maybe_val = v8_function->Call(
-    context, v8::Undefined(isolate), param_types.size(), v8_args.get());
+    context, v8::Undefined(isolate), param_arity, v8_args.get());
+  store->refresh_memories();
 
   if (handler.HasCaught()) {
     auto exception = handler.Exception();
@@ -1724,24 +2532,31 @@ auto Func::call(const vec<Val>& args, vec<Val>& results) const -> own<Trap> {
   }
 
   auto val = maybe_val.ToLocalChecked();
-  if (result_types.size() == 0) {
+  if (result_arity == 0) {
     assert(val->IsUndefined());
-  } else if (result_types.size() == 1) {
+  } else if (result_arity == 1) {
     assert(!val->IsUndefined());
-    new (&results[0]) Val(v8_to_val(store, val, result_types[0].get()));
+    auto kind = static_cast<ValKind>(wasm_v8::func_type_result(v8_func, 0));
+    new (&results[0]) Val(v8_to_val(store, val, kind));
   } else {
     assert(val->IsArray());
     auto array = v8::Local<v8::Array>::Cast(val);
-    for (size_t i = 0; i < result_types.size(); ++i) {
+    for (size_t i = 0; i < result_arity; ++i) {
       auto maybe = array->Get(context, i);
       assert(!maybe.IsEmpty());
-      new (&results[i]) Val(v8_to_val(
-        store, maybe.ToLocalChecked(), result_types[i].get()));
+      auto kind = static_cast<ValKind>(wasm_v8::func_type_result(v8_func, i));
+      new (&results[i]) Val(v8_to_val(store, maybe.ToLocalChecked(), kind));
     }
   }
   return nullptr;
 }
 
+auto Func::call(const vec<Val>& args, vec<Val>& results) const -> own<Trap> {
+  auto func = impl(this);
+  v8::HandleScope handle_scope(func->isolate());
+  return call_function(func->store(), func->v8_object(), args, results);
+}
+
 void FuncData::v8_callback(const v8::FunctionCallbackInfo<v8::Value>& info) {
   auto v8_data = info.Data();
   auto self = reinterpret_cast<FuncData*>(wasm_v8::foreign_get(v8_data));
@@ -1761,6 +2576,7 @@ void FuncData::v8_callback(const v8::FunctionCallbackInfo<v8::Value>& info) {
     args[i] = v8_to_val(store, info[i], param_types[i].get());
   }
 
+  store->refresh_memories();
   own<Trap> trap;
   if (self->kind == CALLBACK_WITH_ENV) {
     trap = self->callback_with_env(self->env, args, results);
@@ -1846,16 +2662,37 @@ auto Global::type() const -> own<GlobalType> {
   return GlobalType::make(ValType::make(kind), mutability);
 }
 
+// Numeric globals are accessed through their raw address, without a
+// handle scope. The content kind is read straight from the global object.
+
+auto global_kind(const Global* global) -> ValKind {
+  return static_cast<ValKind>(wasm_v8::global_type_content(*impl(global)));
+}
+
+template<class T>
+auto global_load(const Global* global, ValKind kind) -> T {
+  assert(global_kind(global) == kind);
+  T val;
+  std::memcpy(&val, wasm_v8::global_address(*impl(global)), sizeof(val));
+  return val;
+}
+
+template<class T>
+void global_store(Global* global, ValKind kind, T val) {
+  assert(global_kind(global) == kind);
+  std::memcpy(wasm_v8::global_address(*impl(global)), &val, sizeof(val));
+}
+
 auto Global::get() const -> Val {
-  v8::HandleScope handle_scope(impl(this)->isolate());
-  auto v8_global = impl(this)->v8_object();
-  switch (type()->content()->kind()) {
-    case ValKind::I32: return Val(wasm_v8::global_get_i32(v8_global));
-    case ValKind::I64: return Val(wasm_v8::global_get_i64(v8_global));
-    case ValKind::F32: return Val(wasm_v8::global_get_f32(v8_global));
-    case ValKind::F64: return Val(wasm_v8::global_get_f64(v8_global));
+  switch (global_kind(this)) {
+    case ValKind::I32: return Val(get_i32());
+    case ValKind::I64: return Val(get_i64());
+    case ValKind::F32: return Val(get_f32());
+    case ValKind::F64: return Val(get_f64());
     case ValKind::EXTERNREF:
     case ValKind::FUNCREF: {
+      v8::HandleScope handle_scope(impl(this)->isolate());
+      auto v8_global = impl(this)->v8_object();
       auto store = impl(this)->store();
       return Val(v8_to_ref(store, wasm_v8::global_get_ref(v8_global)));
     }
@@ -1865,15 +2702,15 @@ auto Global::get() const -> Val {
 }
 
 void Global::set(const Val& val) {
-  v8::HandleScope handle_scope(impl(this)->isolate());
-  auto v8_global = impl(this)->v8_object();
   switch (val.kind()) {
-    case ValKind::I32: return wasm_v8::global_set_i32(v8_global, val.i32());
-    case ValKind::I64: return wasm_v8::global_set_i64(v8_global, val.i64());
-    case ValKind::F32: return wasm_v8::global_set_f32(v8_global, val.f32());
-    case ValKind::F64: return wasm_v8::global_set_f64(v8_global, val.f64());
+    case ValKind::I32: return set_i32(val.i32());
+    case ValKind::I64: return set_i64(val.i64());
+    case ValKind::F32: return set_f32(val.f32());
+    case ValKind::F64: return set_f64(val.f64());
     case ValKind::EXTERNREF:
     case ValKind::FUNCREF: {
+      v8::HandleScope handle_scope(impl(this)->isolate());
+      auto v8_global = impl(this)->v8_object();
       auto store = impl(this)->store();
       return wasm_v8::global_set_ref(v8_global, ref_to_v8(store, val.ref()));
     }
@@ -1882,6 +2719,43 @@ void Global::set(const Val& val) {
   }
 }
 
+auto Global::get_i32() const -> int32_t {
+  return global_load<int32_t>(this, ValKind::I32);
+}
+
+auto Global::get_i64() const -> int64_t {
+  return global_load<int64_t>(this, ValKind::I64);
+}
+
+auto Global::get_f32() const -> float32_t {
+  return global_load<float32_t>(this, ValKind::F32);
+}
+
+auto Global::get_f64() const -> float64_t {
+  return global_load<float64_t>(this, ValKind::F64);
+}
+
+void Global::set_i32(int32_t val) {
+  global_store(this, ValKind::I32, val);
+}
+
+void Global::set_i64(int64_t val) {
+  global_store(this, ValKind::I64, val);
+}
+
+void Global::set_f32(float32_t val) {
+  global_store(this, ValKind::F32, val);
+}
+
+void Global::set_f64(float64_t val) {
+  global_store(this, ValKind::F64, val);
+}
+
+auto Global::raw_address() const -> void* {
+  return is_num(global_kind(this))
+    ? wasm_v8::global_address(*impl(this)) : nullptr;
+}
+
 
 // Table Instances
 
@@ -1913,11 +2787,7 @@ auto Table::make(
   auto table = RefImpl<Table>::make(store, maybe_obj.ToLocalChecked());
   // TODO(wasm+): pass reference initialiser as parameter
   if (table && ref) {
-    auto size = type->limits().min;
-    auto obj = maybe_obj.ToLocalChecked();
-    for (size_t i = 0; i < size; ++i) {
-      wasm_v8::table_set(obj, i, v8::Local<v8::Value>::Cast(init));
-    }
+    wasm_v8::table_fill(maybe_obj.ToLocalChecked(), 0, type->limits().min, init);
   }
   return table;
 }
@@ -1957,6 +2827,74 @@ auto Table::grow(size_t delta, const Ref* ref) -> bool {
   return wasm_v8::table_grow(impl(this)->v8_object(), delta, val);
 }
 
+auto Table::get_range(size_t start, size_t n) const -> ownvec<Ref> {
+  auto store = impl(this)->store();
+  v8::HandleScope handle_scope(store->isolate());
+  std::vector<v8::Local<v8::Value>> values(n);
+  if (!wasm_v8::table_get_range(impl(this)->v8_object(), start, n, values.data())) {
+    return ownvec<Ref>::invalid();
+  }
+  auto refs = ownvec<Ref>::make_uninitialized(n);
+  for (size_t i = 0; i < n; ++i) refs[i] = v8_to_ref(store, values[i]);
+  return refs;
+}
+
+auto Table::set_range(size_t start, const Ref* const refs[], size_t n) -> bool {
+  auto store = impl(this)->store();
+  v8::HandleScope handle_scope(store->isolate());
+  std::vector<v8::Local<v8::Value>> values(n);
+  for (size_t i = 0; i < n; ++i) values[i] = ref_to_v8(store, refs[i]);
+  return wasm_v8::table_set_range(impl(this)->v8_object(), start, n, values.data());
+}
+
+auto Table::fill(size_t start, size_t n, const Ref* ref) -> bool {
+  v8::HandleScope handle_scope(impl(this)->isolate());
+  auto val = ref_to_v8(impl(this)->store(), ref);
+  return wasm_v8::table_fill(impl(this)->v8_object(), start, n, val);
+}
+
+auto Table::copy_from(
+  size_t dst, const Table* src, size_t src_start, size_t n
+) -> bool {
+  // As for Memory::copy_from, the source's isolate must not be touched
+  // unless it is this store's.
+  auto store = impl(this)->store();
+  if (!store->owns_handle(impl(src))) return false;
+  v8::HandleScope handle_scope(store->isolate());
+  return wasm_v8::table_copy(impl(this)->v8_object(), dst,
+    impl(src)->v8_object(), src_start, n);
+}
+
+// Checks the signature against the arguments' kinds and the number of
+// results, then calls the entry in place, like call_indirect.
+auto Table::call(
+  size_t index, const vec<Val>& args, vec<Val>& results
+) const -> own<Trap> {
+  auto table = impl(this);
+  auto store = table->store();
+  v8::HandleScope handle_scope(store->isolate());
+  auto v8_table = table->v8_object();
+  if (index >= wasm_v8::table_size(v8_table)) {
+    return Trap::make(store, Name::make_nt("table index out of bounds"));
+  }
+  auto maybe = wasm_v8::table_get(v8_table, index);
+  if (maybe.IsEmpty()) {
+    return Trap::make(store, Name::make_nt("uninitialized element"));
+  }
+  auto v8_func = v8::Local<v8::Object>::Cast(maybe.ToLocalChecked());
+  auto matches = wasm_v8::object_is_func(v8_func) &&
+    wasm_v8::func_type_param_arity(v8_func) == args.size() &&
+    wasm_v8::func_type_result_arity(v8_func) == results.size();
+  for (size_t i = 0; matches && i < args.size(); ++i) {
+    matches = args[i].kind() ==
+      static_cast<ValKind>(wasm_v8::func_type_param(v8_func, i));
+  }
+  if (!matches) {
+    return Trap::make(store, Name::make_nt("indirect call signature mismatch"));
+  }
+  return call_function(store, v8_func, args, results);
+}
+
 
 // Memory Instances
 
@@ -1981,16 +2919,27 @@ auto Memory::make(Store* store_abs, const MemoryType* type) -> own<Memory> {
   auto maybe_obj =
     store->v8_function(V8_F_MEMORY)->NewInstance(context, 1, args);
   if (maybe_obj.IsEmpty()) return own<Memory>();
+  store->advise_huge_pages(maybe_obj.ToLocalChecked());
   return RefImpl<Memory>::make(store, maybe_obj.ToLocalChecked());
 }
 
+auto Memory::make(
+  Store* store, const MemoryType* type, const MemoryMapping& mapping
+) -> own<Memory> {
+  auto memory = Memory::make(store, type);
+  if (!memory || !memory->map(mapping)) return own<Memory>();
+  return memory;
+}
+
 auto Memory::type() const -> own<MemoryType> {
   // return impl(this)->data->type->copy();
   v8::HandleScope handle_scope(impl(this)->isolate());
   auto v8_memory = impl(this)->v8_object();
   uint32_t min = wasm_v8::memory_type_min(v8_memory);
   uint32_t max = wasm_v8::memory_type_max(v8_memory);
-  return MemoryType::make(Limits(min, max));
+  bool shared = wasm_v8::memory_type_shared(v8_memory);
+  bool is64 = wasm_v8::memory_type_is64(v8_memory);
+  return MemoryType::make(Limits(min, max), shared, is64);
 }
 
 auto Memory::data() const -> byte_t* {
@@ -2010,7 +2959,458 @@ auto Memory::size() const -> pages_t {
 
 auto Memory::grow(pages_t delta) -> bool {
   v8::HandleScope handle_scope(impl(this)->isolate());
-  return wasm_v8::memory_grow(impl(this)->v8_object(), delta);
+  auto result = wasm_v8::memory_grow(impl(this)->v8_object(), delta);
+  impl(this)->store()->refresh_memories();
+  return result;
+}
+
+// Bulk accesses resolve the data once and rely on the C library's
+// vectorized memcpy, memmove and memset.
+
+auto in_bounds(size_t offset, size_t size, size_t data_size) -> bool {
+  return offset <= data_size && size <= data_size - offset;
+}
+
+auto Memory::read(size_t offset, byte_t* out, size_t size) const -> bool {
+  v8::HandleScope handle_scope(impl(this)->isolate());
+  auto v8_memory = impl(this)->v8_object();
+  if (!in_bounds(offset, size, wasm_v8::memory_data_size(v8_memory))) {
+    return false;
+  }
+  if (size > 0) std::memcpy(out, wasm_v8::memory_data(v8_memory) + offset, size);
+  return true;
+}
+
+auto Memory::write(size_t offset, const byte_t* data, size_t size) -> bool {
+  v8::HandleScope handle_scope(impl(this)->isolate());
+  auto v8_memory = impl(this)->v8_object();
+  if (!in_bounds(offset, size, wasm_v8::memory_data_size(v8_memory))) {
+    return false;
+  }
+  if (size > 0) std::memcpy(wasm_v8::memory_data(v8_memory) + offset, data, size);
+  return true;
+}
+
+auto Memory::fill(size_t offset, byte_t value, size_t size) -> bool {
+  v8::HandleScope handle_scope(impl(this)->isolate());
+  auto v8_memory = impl(this)->v8_object();
+  if (!in_bounds(offset, size, wasm_v8::memory_data_size(v8_memory))) {
+    return false;
+  }
+  if (size > 0) std::memset(wasm_v8::memory_data(v8_memory) + offset, value, size);
+  return true;
+}
+
+auto Memory::copy_within(size_t dst, size_t src, size_t size) -> bool {
+  v8::HandleScope handle_scope(impl(this)->isolate());
+  auto v8_memory = impl(this)->v8_object();
+  auto data_size = wasm_v8::memory_data_size(v8_memory);
+  if (!in_bounds(dst, size, data_size) || !in_bounds(src, size, data_size)) {
+    return false;
+  }
+  auto data = wasm_v8::memory_data(v8_memory);
+  if (size > 0) std::memmove(data + dst, data + src, size);
+  return true;
+}
+
+// The memories may be the same, or belong to different stores.
+auto Memory::copy_from(
+  size_t dst, const Memory* src, size_t src_offset, size_t size
+) -> bool {
+  // The source may belong to a store running on another thread, whose
+  // isolate must not be touched from here.
+  auto store = impl(this)->store();
+  if (!store->owns_handle(impl(src))) return false;
+  v8::HandleScope handle_scope(store->isolate());
+  auto v8_memory = impl(this)->v8_object();
+  auto v8_src = impl(src)->v8_object();
+  if (!in_bounds(dst, size, wasm_v8::memory_data_size(v8_memory)) ||
+      !in_bounds(src_offset, size, wasm_v8::memory_data_size(v8_src))) {
+    return false;
+  }
+  if (size == 0) return true;
+  std::memmove(wasm_v8::memory_data(v8_memory) + dst,
+    wasm_v8::memory_data(v8_src) + src_offset, size);
+  return true;
+}
+
+auto Memory::readv(const MemoryIovec iovs[], size_t n) const -> bool {
+  v8::HandleScope handle_scope(impl(this)->isolate());
+  auto v8_memory = impl(this)->v8_object();
+  auto data_size = wasm_v8::memory_data_size(v8_memory);
+  for (size_t i = 0; i < n; ++i) {
+    if (!in_bounds(iovs[i].offset, iovs[i].size, data_size)) return false;
+  }
+  auto data = wasm_v8::memory_data(v8_memory);
+  for (size_t i = 0; i < n; ++i) {
+    if (iovs[i].size == 0) continue;
+    std::memcpy(iovs[i].data, data + iovs[i].offset, iovs[i].size);
+  }
+  return true;
+}
+
+auto Memory::writev(const MemoryIovec iovs[], size_t n) -> bool {
+  v8::HandleScope handle_scope(impl(this)->isolate());
+  auto v8_memory = impl(this)->v8_object();
+  auto data_size = wasm_v8::memory_data_size(v8_memory);
+  for (size_t i = 0; i < n; ++i) {
+    if (!in_bounds(iovs[i].offset, iovs[i].size, data_size)) return false;
+  }
+  auto data = wasm_v8::memory_data(v8_memory);
+  for (size_t i = 0; i < n; ++i) {
+    if (iovs[i].size == 0) continue;
+    std::memcpy(data + iovs[i].offset, iovs[i].data, iovs[i].size);
+  }
+  return true;
+}
+
+// V8 allocates Wasm memories through its page allocator, not through the
+// store's array buffer allocator, so the file is mapped over the committed
+// pages in place.
+auto Memory::map(const MemoryMapping& mapping) -> bool {
+#ifdef __linux__
+  v8::HandleScope handle_scope(impl(this)->isolate());
+  auto v8_memory = impl(this)->v8_object();
+  auto page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  if (mapping.offset % page != 0 || mapping.file_offset % page != 0 ||
+      mapping.size % page != 0 ||
+      !in_bounds(mapping.offset, mapping.size,
+        wasm_v8::memory_data_size(v8_memory))) {
+    return false;
+  }
+  if (mapping.size == 0) return true;
+  // Pages past the end of the file would fault with SIGBUS.
+  struct stat file_stat;
+  if (fstat(mapping.fd, &file_stat) != 0 ||
+      !in_bounds(mapping.file_offset, mapping.size,
+        static_cast<uint64_t>(file_stat.st_size))) {
+    return false;
+  }
+  auto data = wasm_v8::memory_data(v8_memory) + mapping.offset;
+  auto flags = MAP_FIXED | (mapping.shared ? MAP_SHARED : MAP_PRIVATE);
+  return mmap(data, mapping.size, PROT_READ | PROT_WRITE, flags,
+    mapping.fd, static_cast<off_t>(mapping.file_offset)) != MAP_FAILED;
+#else
+  return false;
+#endif
+}
+
+void set_bit(byte_t* bits, size_t i) {
+  bits[i / 8] |= static_cast<byte_t>(1 << (i % 8));
+}
+
+// Replaces a range by fresh private anonymous pages, zero-filled on demand.
+// Unlike madvise(MADV_DONTNEED), this also drops the pages of private file
+// mappings, as made by snapshot restores, map, and resume, which would
+// otherwise read as the file's contents again.
+auto discard_pages(byte_t* data, size_t size) -> bool {
+#ifdef __linux__
+  return size == 0 || mmap(data, size, PROT_READ | PROT_WRITE,
+    MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0) != MAP_FAILED;
+#else
+  std::memset(data, 0, size);
+  return true;
+#endif
+}
+
+// Discarded pages are not flagged soft-dirty, so the range is marked dirty
+// in the memory's tracker, if any, to be reported by dirty_pages.
+auto discard_memory(
+  StoreImpl* store, v8::Local<v8::Object> memory, size_t offset, size_t size
+) -> bool {
+  auto data = wasm_v8::memory_data(memory);
+  if (!discard_pages(data + offset, size)) return false;
+  auto tracker = store->dirty_tracker(memory, false);
+  if (tracker && tracker->epoch != 0 && tracker->base == data) {
+#ifdef __linux__
+    std::lock_guard<std::mutex> lock(dirty_mutex);
+#endif
+    auto page = Memory::dirty_page_size();
+    auto end = std::min(offset + size, tracker->size);
+    for (auto i = offset; i < end; i += page) {
+      set_bit(tracker->dirty.data(), i / page);
+    }
+  }
+  return true;
+}
+
+auto Memory::discard(size_t offset, size_t size) -> bool {
+  v8::HandleScope handle_scope(impl(this)->isolate());
+  auto v8_memory = impl(this)->v8_object();
+  auto page = Memory::dirty_page_size();
+  if (offset % page != 0 || size % page != 0 ||
+      !in_bounds(offset, size, wasm_v8::memory_data_size(v8_memory))) {
+    return false;
+  }
+  return discard_memory(impl(this)->store(), v8_memory, offset, size);
+}
+
+// Dirty page tracking uses the kernel's soft-dirty bits where available:
+// clearing them write-protects all pages of the process, and pages written
+// afterwards are flagged in /proc/self/pagemap. Clearing is process-wide,
+// so the bits of all other tracked memories are saved first, which loses
+// writes made in between. Soft-dirty bits are hence only used for memories
+// that no other thread writes to: unshared memories of a single store at a
+// time, whose other memories are idle while it checkpoints. All other
+// memories, and all memories elsewhere, compare 128-bit hashes of each page
+// against those taken at the checkpoint.
+
+std::atomic<uint64_t> dirty_epoch{0};
+
+auto Memory::dirty_page_size() -> size_t {
+#ifdef __linux__
+  static const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  return page;
+#else
+  return 0x1000;
+#endif
+}
+
+inline auto rotl64(uint64_t x, int r) -> uint64_t {
+  return x << r | x >> (64 - r);
+}
+
+inline auto fmix64(uint64_t k) -> uint64_t {
+  k ^= k >> 33;
+  k *= 0xff51afd7ed558ccdu;
+  k ^= k >> 33;
+  k *= 0xc4ceb9fe1a85ec53u;
+  k ^= k >> 33;
+  return k;
+}
+
+// MurmurHash3's x64 128-bit variant, for sizes that are multiples of 16.
+auto page_hash(const byte_t* data, size_t size) -> DirtyTracker::PageHash {
+  const uint64_t c1 = 0x87c37b91114253d5u;
+  const uint64_t c2 = 0x4cf5ad432745937fu;
+  uint64_t h1 = 0, h2 = 0;
+  for (size_t i = 0; i < size; i += 16) {
+    uint64_t k1, k2;
+    std::memcpy(&k1, data + i, sizeof(k1));
+    std::memcpy(&k2, data + i + 8, sizeof(k2));
+    h1 ^= rotl64(k1 * c1, 31) * c2;
+    h1 = (rotl64(h1, 27) + h2) * 5 + 0x52dce729;
+    h2 ^= rotl64(k2 * c2, 33) * c1;
+    h2 = (rotl64(h2, 31) + h1) * 5 + 0x38495ab5;
+  }
+  h1 ^= size;
+  h2 ^= size;
+  h1 += h2;
+  h2 += h1;
+  h1 = fmix64(h1);
+  h2 = fmix64(h2);
+  h1 += h2;
+  h2 += h1;
+  return DirtyTracker::PageHash{h1, h2};
+}
+
+#ifdef __linux__
+auto clear_soft_dirty() -> bool {
+  auto fd = open("/proc/self/clear_refs", O_WRONLY | O_CLOEXEC);
+  if (fd == -1) return false;
+  auto success = write(fd, "4", 1) == 1;
+  close(fd);
+  return success;
+}
+
+// Sets the bits of pages in a range that are flagged soft-dirty.
+auto read_soft_dirty(const byte_t* base, size_t size, byte_t* bits) -> bool {
+  static const size_t chunk = 512;
+  auto page = Memory::dirty_page_size();
+  auto fd = open("/proc/self/pagemap", O_RDONLY | O_CLOEXEC);
+  if (fd == -1) return false;
+  auto first = reinterpret_cast<uintptr_t>(base) / page;
+  auto n = size / page;
+  uint64_t entries[chunk];
+  auto success = true;
+  for (size_t i = 0; i < n && success; i += chunk) {
+    auto count = std::min(chunk, n - i);
+    auto bytes = static_cast<ssize_t>(count * sizeof(uint64_t));
+    success = pread(fd, entries, bytes, (first + i) * sizeof(uint64_t)) == bytes;
+    for (size_t j = 0; success && j < count; ++j) {
+      if ((entries[j] >> 55) & 1) set_bit(bits, i + j);
+    }
+  }
+  close(fd);
+  return success;
+}
+
+// Some kernels accept clear_refs without tracking soft-dirty bits.
+auto soft_dirty_supported() -> bool {
+  static const bool supported = [] {
+    auto page = Memory::dirty_page_size();
+    auto probe = static_cast<byte_t*>(mmap(nullptr, page,
+      PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+    if (probe == MAP_FAILED) return false;
+    probe[0] = 1;
+    byte_t bits = 0;
+    auto result = clear_soft_dirty();
+    if (result) {
+      *static_cast<volatile byte_t*>(probe) = 2;
+      result = read_soft_dirty(probe, page, &bits) && bits == 1;
+    }
+    munmap(probe, page);
+    return result;
+  }();
+  return supported;
+}
+#endif
+
+auto Memory::checkpoint() -> uint64_t {
+  auto store = impl(this)->store();
+  v8::HandleScope handle_scope(store->isolate());
+  auto v8_memory = impl(this)->v8_object();
+  auto tracker = store->dirty_tracker(v8_memory, true);
+  if (!tracker) return 0;
+  auto base = wasm_v8::memory_data(v8_memory);
+  auto size = wasm_v8::memory_data_size(v8_memory);
+  auto page = dirty_page_size();
+  auto pages = size / page;
+
+#ifdef __linux__
+  if (soft_dirty_supported() && !wasm_v8::memory_type_shared(v8_memory)) {
+    std::lock_guard<std::mutex> lock(dirty_mutex);
+    auto exclusive = std::none_of(
+      dirty_trackers.begin(), dirty_trackers.end(),
+      [=](const DirtyTracker* other) {
+        return other->soft_dirty && other->store != store;
+      });
+    if (exclusive) {
+      for (auto other : dirty_trackers) {
+        if (other == tracker || !other->soft_dirty) continue;
+        if (!read_soft_dirty(other->base, other->size, other->dirty.data())) {
+          return 0;
+        }
+      }
+      if (!clear_soft_dirty()) return 0;
+      tracker->soft_dirty = true;
+      tracker->dirty.assign((pages + 7) / 8, 0);
+      tracker->hashes.clear();
+      tracker->hashes.shrink_to_fit();
+      tracker->base = base;
+      tracker->size = size;
+      tracker->epoch = ++dirty_epoch;
+      return tracker->epoch;
+    }
+  }
+  {
+    std::lock_guard<std::mutex> lock(dirty_mutex);
+    tracker->soft_dirty = false;
+  }
+#endif
+
+  tracker->dirty.assign((pages + 7) / 8, 0);
+  tracker->hashes.resize(pages);
+  for (size_t i = 0; i < pages; ++i) {
+    tracker->hashes[i] = page_hash(base + i * page, page);
+  }
+  tracker->base = base;
+  tracker->size = size;
+  tracker->epoch = ++dirty_epoch;
+  return tracker->epoch;
+}
+
+auto Memory::dirty_pages(uint64_t since_epoch) const -> vec<byte_t> {
+  auto store = impl(this)->store();
+  v8::HandleScope handle_scope(store->isolate());
+  auto v8_memory = impl(this)->v8_object();
+  auto tracker = store->dirty_tracker(v8_memory, false);
+  if (!tracker || since_epoch == 0 || tracker->epoch != since_epoch) {
+    return vec<byte_t>::invalid();
+  }
+  auto base = wasm_v8::memory_data(v8_memory);
+  auto size = wasm_v8::memory_data_size(v8_memory);
+  auto page = dirty_page_size();
+  auto pages = size / page;
+  auto bits = vec<byte_t>::make_uninitialized((pages + 7) / 8);
+  if (!bits) return vec<byte_t>::invalid();
+  if (bits.size() > 0) std::memset(bits.get(), 0, bits.size());
+
+  // Pages added by growing, or all if the memory moved, count as dirty.
+  auto tracked = base == tracker->base ? tracker->size / page : 0;
+  for (size_t i = tracked; i < pages; ++i) set_bit(bits.get(), i);
+
+#ifdef __linux__
+  if (tracker->soft_dirty) {
+    std::lock_guard<std::mutex> lock(dirty_mutex);
+    for (size_t i = 0; i < tracker->dirty.size(); ++i) {
+      bits[i] |= tracker->dirty[i];
+    }
+    if (!read_soft_dirty(base, tracked * page, bits.get())) {
+      return vec<byte_t>::invalid();
+    }
+    return bits;
+  }
+#endif
+
+  for (size_t i = 0; i < tracker->dirty.size(); ++i) {
+    bits[i] |= tracker->dirty[i];
+  }
+  for (size_t i = 0; i < tracked; ++i) {
+    auto hash = page_hash(base + i * page, page);
+    if (hash.lo != tracker->hashes[i].lo || hash.hi != tracker->hashes[i].hi) {
+      set_bit(bits.get(), i);
+    }
+  }
+  return bits;
+}
+
+auto Memory::view() const -> MemoryView {
+  auto memory = impl(this);
+  auto store = memory->store();
+  v8::HandleScope handle_scope(store->isolate());
+  auto v8_memory = memory->v8_object();
+  auto base = wasm_v8::memory_data(v8_memory);
+  auto size = wasm_v8::memory_data_size(v8_memory);
+  store->watch_memory(v8_memory, base, size);
+  return MemoryView{base, size, store->memory_generation()};
+}
+
+// Sharing hands out the backing store, which V8 reference-counts across
+// isolates. Each store obtaining it wraps it in its own memory object.
+
+template<>
+struct SharedImpl<Memory> : Shared<Memory> {
+  std::shared_ptr<v8::BackingStore> backing_store;
+  uint32_t max;
+  bool is64;
+
+  SharedImpl(
+    std::shared_ptr<v8::BackingStore> backing_store, uint32_t max, bool is64
+  ) : backing_store(std::move(backing_store)), max(max), is64(is64)
+  {
+    stats.make(Stats::MEMORY, this, Stats::SHARED);
+  }
+
+  void destroy() {
+    stats.free(Stats::MEMORY, this, Stats::SHARED);
+    delete this;
+  }
+};
+
+template<> struct implement<Shared<Memory>> { using type = SharedImpl<Memory>; };
+
+void Shared<Memory>::destroy() {
+  impl(this)->destroy();
+}
+
+auto Memory::share() const -> own<Shared<Memory>> {
+  v8::HandleScope handle_scope(impl(this)->isolate());
+  auto v8_memory = impl(this)->v8_object();
+  if (!wasm_v8::memory_type_shared(v8_memory)) return own<Shared<Memory>>();
+  return own<Shared<Memory>>(new(std::nothrow) SharedImpl<Memory>(
+    wasm_v8::memory_backing_store(v8_memory),
+    wasm_v8::memory_type_max(v8_memory),
+    wasm_v8::memory_type_is64(v8_memory)));
+}
+
+auto Memory::obtain(Store* store_abs, const Shared<Memory>* shared) -> own<Memory> {
+  auto store = impl(store_abs);
+  v8::HandleScope handle_scope(store->isolate());
+  auto v8_memory = wasm_v8::memory_new_shared(
+    store->isolate(), impl(shared)->backing_store, impl(shared)->max,
+    impl(shared)->is64);
+  return RefImpl<Memory>::make(store, v8_memory);
 }
 
 
@@ -2027,34 +3427,25 @@ auto Instance::copy() const -> own<Instance> {
   return impl(this)->copy();
 }
 
-auto Instance::make(
-  Store* store_abs, const Module* module_abs, const vec<Extern*>& imports,
-  own<Trap>* trap
-) -> own<Instance> {
-  auto store = impl(store_abs);
-  auto module = impl(module_abs);
+// Builds the JS import object from externs given in import order.
+auto imports_object(
+  StoreImpl* store, v8::Local<v8::Object> module, const ModuleData* data,
+  const Extern* const* imports
+) -> v8::MaybeLocal<v8::Object> {
   auto isolate = store->isolate();
   auto context = store->context();
-  v8::HandleScope handle_scope(isolate);
-
-  assert(wasm_v8::object_isolate(module->v8_object()) == isolate);
-
-  if (trap) *trap = nullptr;
-  auto import_types = module_abs->imports();
+  v8::Local<v8::Array> names;
+  if (!module_names(store, module, data).ToLocal(&names)) {
+    return v8::MaybeLocal<v8::Object>();
+  }
+  auto n = data->info.imports.size();
   auto imports_obj = v8::Object::New(isolate);
-  for (size_t i = 0; i < import_types.size(); ++i) {
-    auto type = import_types[i].get();
-    auto maybe_module = v8::String::NewFromOneByte(
-      isolate, reinterpret_cast<const uint8_t*>(type->module().get()),
-      v8::NewStringType::kNormal, type->module().size()
-    );
-    if (maybe_module.IsEmpty()) return own<Instance>();
+  for (size_t i = 0; i < n; ++i) {
+    auto maybe_module = module_name(store, names, 2 * i);
+    if (maybe_module.IsEmpty()) return v8::MaybeLocal<v8::Object>();
     auto module_str = maybe_module.ToLocalChecked();
-    auto maybe_name = v8::String::NewFromOneByte(
-      isolate, reinterpret_cast<const uint8_t*>(type->name().get()),
-      v8::NewStringType::kNormal, type->name().size()
-    );
-    if (maybe_name.IsEmpty()) return own<Instance>();
+    auto maybe_name = module_name(store, names, 2 * i + 1);
+    if (maybe_name.IsEmpty()) return v8::MaybeLocal<v8::Object>();
     auto name_str = maybe_name.ToLocalChecked();
 
     v8::Local<v8::Object> module_obj;
@@ -2069,11 +3460,19 @@ auto Instance::make(
     ignore(module_obj->DefineOwnProperty(
       context, name_str, extern_to_v8(imports[i])));
   }
+  return imports_obj;
+}
 
-  v8::TryCatch handler(isolate);
-  v8::Local<v8::Value> instantiate_args[] = {module->v8_object(), imports_obj};
+auto instantiate(
+  StoreImpl* store, v8::Local<v8::Object> module,
+  v8::Local<v8::Object> imports_obj, v8::TryCatch& handler, own<Trap>* trap
+) -> own<Instance> {
+  auto context = store->context();
+
+  v8::Local<v8::Value> instantiate_args[] = {module, imports_obj};
   auto obj = store->v8_function(V8_F_INSTANCE)->NewInstance(
     context, 2, instantiate_args);
+  store->refresh_memories();  // the start function may have grown memories
 
   if (handler.HasCaught() && trap) {
     auto exception = handler.Exception();
@@ -2086,15 +3485,123 @@ auto Instance::make(
     *trap = RefImpl<Trap>::make(store, v8::Local<v8::Object>::Cast(exception));
     return nullptr;
   }
+  if (obj.IsEmpty()) return nullptr;
 
+  auto memory = wasm_v8::instance_memory(obj.ToLocalChecked());
+  if (!memory.IsEmpty()) store->advise_huge_pages(memory.ToLocalChecked());
   return RefImpl<Instance>::make(store, obj.ToLocalChecked());
 }
 
+auto instantiate(
+  StoreImpl* store, v8::Local<v8::Object> module,
+  v8::Local<v8::Object> imports_obj, own<Trap>* trap
+) -> own<Instance> {
+  v8::TryCatch handler(store->isolate());
+  return instantiate(store, module, imports_obj, handler, trap);
+}
+
+auto Instance::make(
+  Store* store_abs, const Module* module_abs, const vec<Extern*>& imports,
+  own<Trap>* trap
+) -> own<Instance> {
+  auto store = impl(store_abs);
+  auto module = impl(module_abs);
+  auto isolate = store->isolate();
+  v8::HandleScope handle_scope(isolate);
+
+  assert(wasm_v8::object_isolate(module->v8_object()) == isolate);
+
+  if (trap) *trap = nullptr;
+  auto data = module_data(store, module->v8_object());
+  if (!data) return own<Instance>();
+  auto maybe_imports_obj =
+    imports_object(store, module->v8_object(), data, imports.get());
+  if (maybe_imports_obj.IsEmpty()) return own<Instance>();
+  return instantiate(store, module->v8_object(),
+    maybe_imports_obj.ToLocalChecked(), trap);
+}
+
+// Module data, the V8 constructor and the exception handler are set up once.
+// Consecutive instances with the same imports share one import object.
+auto Instance::make_many(
+  Store* store_abs, const Module* module_abs, const vec<Extern*> imports[],
+  size_t n, own<Trap>* trap
+) -> ownvec<Instance> {
+  auto store = impl(store_abs);
+  auto module = impl(module_abs);
+  auto isolate = store->isolate();
+  v8::HandleScope handle_scope(isolate);
+
+  assert(wasm_v8::object_isolate(module->v8_object()) == isolate);
+
+  if (trap) *trap = nullptr;
+  auto data = module_data(store, module->v8_object());
+  if (!data) return ownvec<Instance>::invalid();
+  auto instances = ownvec<Instance>::make_uninitialized(n);
+  if (!instances) return ownvec<Instance>::invalid();
+
+  auto module_obj = module->v8_object();
+  v8::Global<v8::Object> imports_obj;
+  v8::TryCatch handler(isolate);
+  for (size_t i = 0; i < n; ++i) {
+    v8::HandleScope instance_scope(isolate);
+    auto same = i > 0 && imports[i].size() == imports[i - 1].size() &&
+      (imports[i].size() == 0 || std::memcmp(imports[i].get(),
+        imports[i - 1].get(), imports[i].size() * sizeof(Extern*)) == 0);
+    if (!same) {
+      v8::Local<v8::Object> obj;
+      if (!imports_object(store, module_obj, data, imports[i].get())
+            .ToLocal(&obj)) {
+        return ownvec<Instance>::invalid();
+      }
+      imports_obj.Reset(isolate, obj);
+    }
+    instances[i] = instantiate(
+      store, module_obj, imports_obj.Get(isolate), handler, trap);
+    if (!instances[i]) return ownvec<Instance>::invalid();
+  }
+  return instances;
+}
+
+// Names are the module's, from module_names.
+auto export_extern(
+  StoreImpl* store, v8::Local<v8::Array> names, const ModuleData* data,
+  v8::Local<v8::Object> exports_obj, size_t index
+) -> own<Extern> {
+  auto context = store->context();
+  auto& info = data->info.exports[index];
+  auto maybe_name_obj =
+    module_name(store, names, 2 * data->info.imports.size() + index);
+  if (maybe_name_obj.IsEmpty()) return nullptr;
+  auto name_obj = maybe_name_obj.ToLocalChecked();
+  auto obj = v8::Local<v8::Object>::Cast(
+    exports_obj->Get(context, name_obj).ToLocalChecked());
+
+  switch (info.type.kind) {
+    case ExternKind::FUNC: {
+      assert(wasm_v8::extern_kind(obj) == wasm_v8::EXTERN_FUNC);
+      return RefImpl<Func>::make(store, obj);
+    }
+    case ExternKind::GLOBAL: {
+      assert(wasm_v8::extern_kind(obj) == wasm_v8::EXTERN_GLOBAL);
+      return RefImpl<Global>::make(store, obj);
+    }
+    case ExternKind::TABLE: {
+      assert(wasm_v8::extern_kind(obj) == wasm_v8::EXTERN_TABLE);
+      return RefImpl<Table>::make(store, obj);
+    }
+    case ExternKind::MEMORY: {
+      assert(wasm_v8::extern_kind(obj) == wasm_v8::EXTERN_MEMORY);
+      return RefImpl<Memory>::make(store, obj);
+    }
+  }
+  return nullptr;
+}
+
 auto Instance::exports() const -> ownvec<Extern> {
   auto instance = impl(this);
   auto store = instance->store();
   auto isolate = store->isolate();
-  auto context = store->context();
   v8::HandleScope handle_scope(isolate);
 
   auto module_obj = wasm_v8::instance_module(instance->v8_object());
@@ -2102,44 +3609,743 @@ auto Instance::exports() const -> ownvec<Extern> {
   assert(!module_obj.IsEmpty() && module_obj->IsObject());
   assert(!exports_obj.IsEmpty() && exports_obj->IsObject());
 
-  auto module = RefImpl<Module>::make(store, module_obj);
-  auto export_types = module->exports();
-  auto exports = ownvec<Extern>::make_uninitialized(export_types.size());
+  auto data = module_data(store, module_obj);
+  if (!data) return ownvec<Extern>::invalid();
+  auto& export_infos = data->info.exports;
+  auto exports = ownvec<Extern>::make_uninitialized(export_infos.size());
   if (!exports) return ownvec<Extern>::invalid();
+  v8::Local<v8::Array> names;
+  if (!module_names(store, module_obj, data).ToLocal(&names)) {
+    return ownvec<Extern>::invalid();
+  }
 
-  for (size_t i = 0; i < export_types.size(); ++i) {
-    auto& name = export_types[i]->name();
-    auto maybe_name_obj = v8::String::NewFromUtf8(isolate, name.get(),
-      v8::NewStringType::kNormal, name.size());
-    if (maybe_name_obj.IsEmpty()) return ownvec<Extern>::invalid();
-    auto name_obj = maybe_name_obj.ToLocalChecked();
-    auto obj = v8::Local<v8::Object>::Cast(
-      exports_obj->Get(context, name_obj).ToLocalChecked());
-
-    auto type = export_types[i]->type();
-    switch (type->kind()) {
-      case ExternKind::FUNC: {
-        assert(wasm_v8::extern_kind(obj) == wasm_v8::EXTERN_FUNC);
-        exports[i] = RefImpl<Func>::make(store, obj);
-      } break;
-      case ExternKind::GLOBAL: {
-        assert(wasm_v8::extern_kind(obj) == wasm_v8::EXTERN_GLOBAL);
-        exports[i] = RefImpl<Global>::make(store, obj);
-      } break;
-      case ExternKind::TABLE: {
-        assert(wasm_v8::extern_kind(obj) == wasm_v8::EXTERN_TABLE);
-        exports[i] = RefImpl<Table>::make(store, obj);
-      } break;
-      case ExternKind::MEMORY: {
-        assert(wasm_v8::extern_kind(obj) == wasm_v8::EXTERN_MEMORY);
-        exports[i] = RefImpl<Memory>::make(store, obj);
-      } break;
-    }
+  for (size_t i = 0; i < export_infos.size(); ++i) {
+    exports[i] = export_extern(store, names, data, exports_obj, i);
+    if (!exports[i]) return ownvec<Extern>::invalid();
   }
 
   return exports;
 }
 
+auto Instance::export_by_index(size_t index) const -> own<Extern> {
+  auto instance = impl(this);
+  auto store = instance->store();
+  v8::HandleScope handle_scope(store->isolate());
+
+  auto module_obj = wasm_v8::instance_module(instance->v8_object());
+  auto data = module_data(store, module_obj);
+  if (!data || index >= data->info.exports.size()) return nullptr;
+  v8::Local<v8::Array> names;
+  if (!module_names(store, module_obj, data).ToLocal(&names)) return nullptr;
+  auto exports_obj = wasm_v8::instance_exports(instance->v8_object());
+  return export_extern(store, names, data, exports_obj, index);
+}
+
+auto Instance::export_by_name(const Name& name) const -> own<Extern> {
+  auto instance = impl(this);
+  auto store = instance->store();
+  v8::HandleScope handle_scope(store->isolate());
+
+  auto module_obj = wasm_v8::instance_module(instance->v8_object());
+  auto data = module_data(store, module_obj);
+  if (!data) return nullptr;
+  if (!data->has_export_names) {
+    data->export_names = bin::export_names(data->info);
+    data->has_export_names = true;
+  }
+  auto index = bin::find_export(
+    data->info, data->export_names, bin::Span{name.get(), name.size()});
+  if (index == SIZE_MAX) return nullptr;
+  v8::Local<v8::Array> names;
+  if (!module_names(store, module_obj, data).ToLocal(&names)) return nullptr;
+  auto exports_obj = wasm_v8::instance_exports(instance->v8_object());
+  return export_extern(store, names, data, exports_obj, index);
+}
+
+
+// Instance Snapshots
+
+// A snapshot holds the state an instance built up after instantiation: the
+// contents of its own linear memory, its own mutable numeric globals, and
+// the entries of its own tables. New instances are created from a variant
+// of the module without start function, whose active segments for its own
+// memory and tables are empty, and then take over that state. On Linux,
+// memory contents are kept in a sealed memfd that is mapped copy-on-write
+// over the new instance's memory, so pages are only copied once written to.
+
+struct SnapshotImpl : Snapshot {
+  struct TableEntry {
+    uint32_t func_index;  // own function, or kNoFunc
+    v8::Global<v8::Value> ref;  // otherwise, empty if null
+  };
+  static const uint32_t kNoFunc = UINT32_MAX;
+
+  StoreImpl* store;
+  v8::Persistent<v8::Object> module;  // the snapshotted instance's module
+  v8::Persistent<v8::Object> startless;  // module without start function
+  ModuleData* data;  // owned by module
+  bool has_memory = false;
+  size_t memory_size = 0;
+  byte_t* memory = nullptr;  // read-only contents
+#ifdef __linux__
+  int memory_fd = -1;
+#endif
+  std::vector<byte_t> globals;
+  std::vector<std::pair<size_t, size_t>> global_spans;  // offset and size
+  std::vector<std::vector<TableEntry>> tables;  // defined tables only
+
+  SnapshotImpl() {
+    stats.make(Stats::SNAPSHOT, this);
+  }
+
+  ~SnapshotImpl() {
+#ifdef __linux__
+    if (memory_fd != -1) {
+      if (memory) munmap(memory, memory_size);
+      close(memory_fd);
+    } else {
+      delete[] memory;
+    }
+#else
+    delete[] memory;
+#endif
+    module.Reset();
+    startless.Reset();
+    stats.free(Stats::SNAPSHOT, this);
+  }
+
+  auto save_memory(const byte_t* data, size_t size) -> bool {
+    memory_size = size;
+    if (size == 0) return true;
+#ifdef __linux__
+    memory_fd = memfd_create("wasm-snapshot", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (memory_fd != -1) {
+      auto shared = ftruncate(memory_fd, size) == 0
+        ? mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, memory_fd, 0)
+        : MAP_FAILED;
+      if (shared != MAP_FAILED) {
+        std::memcpy(shared, data, size);
+        munmap(shared, size);
+        fcntl(memory_fd, F_ADD_SEALS,
+          F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL);
+        auto view = mmap(nullptr, size, PROT_READ, MAP_SHARED, memory_fd, 0);
+        if (view != MAP_FAILED) {
+          memory = static_cast<byte_t*>(view);
+          return true;
+        }
+      }
+      close(memory_fd);
+      memory_fd = -1;
+    }
+#endif
+    memory = new(std::nothrow) byte_t[size];
+    if (!memory) return false;
+    std::memcpy(memory, data, size);
+    return true;
+  }
+
+  void restore_memory(byte_t* data) const {
+    if (memory_size == 0) return;
+#ifdef __linux__
+    if (memory_fd != -1 && mmap(data, memory_size, PROT_READ | PROT_WRITE,
+          MAP_PRIVATE | MAP_FIXED, memory_fd, 0) != MAP_FAILED) {
+      return;
+    }
+#endif
+    std::memcpy(data, memory, memory_size);
+  }
+};
+
+template<> struct implement<Snapshot> { using type = SnapshotImpl; };
+
+
+void Snapshot::destroy() {
+  delete impl(this);
+}
+
+auto Snapshot::memory_size() const -> size_t {
+  return impl(this)->memory_size;
+}
+
+auto Instance::snapshot() const -> own<Snapshot> {
+  auto instance = impl(this);
+  auto store = instance->store();
+  auto isolate = store->isolate();
+  auto context = store->context();
+  v8::HandleScope handle_scope(isolate);
+
+  auto instance_obj = instance->v8_object();
+  auto module_obj = wasm_v8::instance_module(instance_obj);
+  auto data = module_data(store, module_obj);
+  if (!data) return own<Snapshot>();
+  auto snapshot = own<SnapshotImpl>(new(std::nothrow) SnapshotImpl());
+  if (!snapshot) return own<Snapshot>();
+  snapshot->store = store;
+  snapshot->data = data;
+  snapshot->module.Reset(isolate, module_obj);
+
+  // Compile the module once more without its start function, and without
+  // the contents of active segments for state that the snapshot restores.
+  // Imported memories and tables belong to the host and are left alone.
+  auto maybe_memory = wasm_v8::instance_memory(instance_obj);
+  auto own_memory = bin::count(data->info, ExternKind::MEMORY) == 0 &&
+    !maybe_memory.IsEmpty();
+  auto first_table = bin::count(data->info, ExternKind::TABLE);
+  if (data->index.section(bin::SEC_START) != nullptr ||
+      data->index.section(bin::SEC_ELEM) != nullptr ||
+      (own_memory && data->index.section(bin::SEC_DATA) != nullptr)) {
+    auto binary = vec<byte_t>::adopt(
+      wasm_v8::module_binary_size(module_obj),
+      const_cast<byte_t*>(wasm_v8::module_binary(module_obj))
+    );
+    auto stripped = bin::empty_active_segments(
+      bin::strip_section(binary, bin::SEC_START), own_memory, first_table);
+    binary.release();
+    auto array_buffer = v8::ArrayBuffer::New(isolate, stripped.size());
+    memcpy(array_buffer->GetBackingStore()->Data(),
+      stripped.get(), stripped.size());
+    v8::Local<v8::Value> args[] = {array_buffer};
+    auto maybe_obj =
+      store->v8_function(V8_F_MODULE)->NewInstance(context, 1, args);
+    if (maybe_obj.IsEmpty()) return own<Snapshot>();
+    snapshot->startless.Reset(isolate, maybe_obj.ToLocalChecked());
+  } else {
+    snapshot->startless.Reset(isolate, module_obj);
+  }
+
+  if (own_memory) {
+    auto memory = maybe_memory.ToLocalChecked();
+    snapshot->has_memory = true;
+    if (!snapshot->save_memory(wasm_v8::memory_data(memory),
+          wasm_v8::memory_data_size(memory))) {
+      return own<Snapshot>();
+    }
+  }
+
+  auto globals = wasm_v8::instance_globals_data(instance_obj);
+  snapshot->globals.assign(
+    globals, globals + wasm_v8::instance_globals_size(instance_obj));
+  auto n_globals = wasm_v8::instance_global_count(instance_obj);
+  for (uint32_t g = 0; g < n_globals; ++g) {
+    size_t offset, size;
+    if (wasm_v8::instance_global_span(instance_obj, g, &offset, &size)) {
+      snapshot->global_spans.emplace_back(offset, size);
+    }
+  }
+
+  auto n_tables = wasm_v8::instance_table_count(instance_obj);
+  for (uint32_t t = first_table; t < n_tables; ++t) {
+    auto table = wasm_v8::instance_table(instance_obj, t);
+    auto size = wasm_v8::table_size(table);
+    snapshot->tables.emplace_back(size);
+    auto& entries = snapshot->tables.back();
+    for (size_t i = 0; i < size; ++i) {
+      auto& entry = entries[i];
+      entry.func_index = SnapshotImpl::kNoFunc;
+      auto maybe_value = wasm_v8::table_get(table, i);
+      if (maybe_value.IsEmpty()) continue;
+      auto value = maybe_value.ToLocalChecked();
+      if (value->IsFunction()) {
+        auto func = v8::Local<v8::Function>::Cast(value);
+        if (wasm_v8::object_is_func(func) &&
+            wasm_v8::func_instance(func)->StrictEquals(instance_obj)) {
+          entry.func_index = wasm_v8::func_index(func);
+          continue;
+        }
+      }
+      entry.ref.Reset(isolate, value);
+    }
+  }
+
+  return own<Snapshot>(snapshot.release());
+}
+
+// Restores the snapshotted state into an instance of the snapshot's module.
+// Fails if memory or tables cannot be grown to the snapshotted size.
+auto restore(
+  const SnapshotImpl* snapshot, v8::Local<v8::Object> instance_obj
+) -> bool {
+  auto isolate = snapshot->store->isolate();
+
+  if (snapshot->has_memory) {
+    auto memory = wasm_v8::instance_memory(instance_obj).ToLocalChecked();
+    auto size = wasm_v8::memory_data_size(memory);
+    if (size < snapshot->memory_size) {
+      auto delta = (snapshot->memory_size - size) / Memory::page_size;
+      if (!wasm_v8::memory_grow(memory, static_cast<uint32_t>(delta))) {
+        return false;
+      }
+      snapshot->store->refresh_memories();
+    }
+    snapshot->restore_memory(wasm_v8::memory_data(memory));
+  }
+
+  // Other globals may depend on imports, which can differ.
+  auto globals = wasm_v8::instance_globals_data(instance_obj);
+  for (auto& span : snapshot->global_spans) {
+    std::memcpy(globals + span.first,
+      snapshot->globals.data() + span.first, span.second);
+  }
+
+  auto first = bin::count(snapshot->data->info, ExternKind::TABLE);
+  for (size_t t = 0; t < snapshot->tables.size(); ++t) {
+    auto& entries = snapshot->tables[t];
+    auto table = wasm_v8::instance_table(instance_obj, first + t);
+    auto size = wasm_v8::table_size(table);
+    if (size < entries.size() &&
+        !wasm_v8::table_grow(table, entries.size() - size, v8::Null(isolate))) {
+      return false;
+    }
+    for (size_t i = 0; i < entries.size(); ++i) {
+      auto& entry = entries[i];
+      auto value =
+        entry.func_index != SnapshotImpl::kNoFunc
+          ? wasm_v8::instance_func(instance_obj, entry.func_index)
+          : entry.ref.IsEmpty()
+            ? v8::Local<v8::Value>(v8::Null(isolate))
+            : entry.ref.Get(isolate);
+      if (!wasm_v8::table_set(table, i, value)) return false;
+    }
+  }
+
+  return true;
+}
+
+auto Instance::make_from_snapshot(
+  Store* store_abs, const Snapshot* snapshot_abs, const vec<Extern*>& imports,
+  own<Trap>* trap
+) -> own<Instance> {
+  auto store = impl(store_abs);
+  auto snapshot = impl(snapshot_abs);
+  auto isolate = store->isolate();
+  v8::HandleScope handle_scope(isolate);
+
+  if (trap) *trap = nullptr;
+  if (snapshot->store != store) return own<Instance>();
+  auto maybe_imports_obj = imports_object(
+    store, snapshot->module.Get(isolate), snapshot->data, imports.get());
+  if (maybe_imports_obj.IsEmpty()) return own<Instance>();
+  auto instance = instantiate(store, snapshot->startless.Get(isolate),
+    maybe_imports_obj.ToLocalChecked(), trap);
+  if (!instance) return nullptr;
+  if (!restore(snapshot, impl(instance.get())->v8_object())) return nullptr;
+  return instance;
+}
+
+
+// Instance Hibernation
+
+// A hibernation file holds a header, the indices of the memory's non-zero
+// pages in ascending order, and their contents starting at the next page
+// boundary, so that runs of pages can be mapped straight from the file.
+// The format is native to the host.
+
+struct HibernationHeader {
+  char magic[8];
+  uint64_t page_size;
+  uint64_t memory_size;
+  uint64_t page_count;
+};
+
+const char hibernation_magic[8] = {'\0', 'w', 'a', 's', 'm', 'h', 'i', 'b'};
+
+auto page_is_zero(const byte_t* data, size_t size) -> bool {
+  for (size_t i = 0; i < size; i += sizeof(uint64_t)) {
+    uint64_t word;
+    std::memcpy(&word, data + i, sizeof(word));
+    if (word != 0) return false;
+  }
+  return true;
+}
+
+auto hibernation_data_offset(uint64_t page_count, size_t page) -> uint64_t {
+  auto size = sizeof(HibernationHeader) + page_count * sizeof(uint64_t);
+  return (size + page - 1) / page * page;
+}
+
+void instance_memory_data(
+  v8::Local<v8::Object> instance, v8::Local<v8::Object>* memory,
+  byte_t** data, size_t* size
+) {
+  auto maybe_memory = wasm_v8::instance_memory(instance);
+  *data = nullptr;
+  *size = 0;
+  if (maybe_memory.IsEmpty()) return;
+  *memory = maybe_memory.ToLocalChecked();
+  *data = wasm_v8::memory_data(*memory);
+  *size = wasm_v8::memory_data_size(*memory);
+}
+
+auto Instance::hibernate(const char* path) -> bool {
+  v8::HandleScope handle_scope(impl(this)->isolate());
+  v8::Local<v8::Object> memory;
+  byte_t* data;
+  size_t size;
+  instance_memory_data(impl(this)->v8_object(), &memory, &data, &size);
+
+  auto page = Memory::dirty_page_size();
+  std::vector<uint64_t> pages;
+  for (size_t offset = 0; offset < size; offset += page) {
+    if (!page_is_zero(data + offset, page)) pages.push_back(offset / page);
+  }
+  HibernationHeader header;
+  std::memcpy(header.magic, hibernation_magic, sizeof(header.magic));
+  header.page_size = page;
+  header.memory_size = size;
+  header.page_count = pages.size();
+
+  // Pages resumed from an earlier file at the same path are still mapped
+  // from it, so it is replaced by renaming rather than truncated in place.
+  auto temp_path = std::string(path) + ".tmp";
+  auto file = std::fopen(temp_path.c_str(), "wb");
+  if (!file) return false;
+  auto index_end = sizeof(header) + pages.size() * sizeof(uint64_t);
+  std::vector<byte_t> padding(
+    hibernation_data_offset(pages.size(), page) - index_end, 0);
+  auto ok =
+    std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+    std::fwrite(pages.data(), sizeof(uint64_t), pages.size(), file) ==
+      pages.size() &&
+    std::fwrite(padding.data(), 1, padding.size(), file) == padding.size();
+  for (size_t i = 0; ok && i < pages.size(); ++i) {
+    ok = std::fwrite(data + pages[i] * page, 1, page, file) == page;
+  }
+  ok = std::fclose(file) == 0 && ok;
+  if (ok && std::rename(temp_path.c_str(), path) != 0) {
+    // Some systems do not rename over existing files.
+    ok = std::remove(path) == 0 && std::rename(temp_path.c_str(), path) == 0;
+  }
+  if (!ok) {
+    std::remove(temp_path.c_str());
+    return false;
+  }
+  return size == 0 || discard_memory(impl(this)->store(), memory, 0, size);
+}
+
+#ifdef __linux__
+// Maps each run of consecutive pages privately, so that they fault in from
+// the file on first access. Fails unless the file holds all pages.
+auto map_hibernated_pages(
+  int fd, uint64_t data_offset, const std::vector<uint64_t>& pages,
+  byte_t* data, size_t page
+) -> bool {
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0 ||
+      static_cast<uint64_t>(file_stat.st_size) <
+        data_offset + pages.size() * page) {
+    return false;
+  }
+  for (size_t i = 0; i < pages.size();) {
+    auto j = i + 1;
+    while (j < pages.size() && pages[j] == pages[j - 1] + 1) ++j;
+    auto mapped = mmap(data + pages[i] * page, (j - i) * page,
+      PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd,
+      static_cast<off_t>(data_offset + i * page));
+    if (mapped == MAP_FAILED) return false;
+    i = j;
+  }
+  return true;
+}
+#endif
+
+auto Instance::resume(const char* path) -> bool {
+  v8::HandleScope handle_scope(impl(this)->isolate());
+  v8::Local<v8::Object> memory;
+  byte_t* data;
+  size_t size;
+  instance_memory_data(impl(this)->v8_object(), &memory, &data, &size);
+
+  auto page = Memory::dirty_page_size();
+  auto file = std::fopen(path, "rb");
+  if (!file) return false;
+  HibernationHeader header;
+  std::vector<uint64_t> pages;
+  auto ok = std::fread(&header, sizeof(header), 1, file) == 1 &&
+    std::memcmp(header.magic, hibernation_magic, sizeof(header.magic)) == 0 &&
+    header.page_size == page && header.memory_size <= size &&
+    header.page_count <= header.memory_size / page;
+  if (ok) {
+    pages.resize(header.page_count);
+    ok = std::fread(pages.data(), sizeof(uint64_t), pages.size(), file) ==
+      pages.size();
+  }
+  for (size_t i = 0; ok && i < pages.size(); ++i) {
+    ok = pages[i] < header.memory_size / page &&
+      (i == 0 || pages[i] > pages[i - 1]);
+  }
+  // Pages written since hibernation are dropped.
+  ok = ok &&
+    (size == 0 || discard_memory(impl(this)->store(), memory, 0, size));
+  if (ok) {
+    auto data_offset = hibernation_data_offset(pages.size(), page);
+    auto mapped = false;
+#ifdef __linux__
+    mapped = map_hibernated_pages(fileno(file), data_offset, pages, data, page);
+#endif
+    if (!mapped) {
+      ok = std::fseek(file, static_cast<long>(data_offset), SEEK_SET) == 0;
+      for (size_t i = 0; ok && i < pages.size(); ++i) {
+        ok = std::fread(data + pages[i] * page, 1, page, file) == page;
+      }
+    }
+  }
+  std::fclose(file);
+  return ok;
+}
+
+
+// Instance Pools
+
+// Pooled instances all derive from a snapshot taken right after the first
+// instantiation. Returned instances are reset by restoring that snapshot,
+// which on Linux drops all dirtied memory pages by remapping the snapshot
+// copy-on-write. Instances whose memory or tables have grown beyond the
+// snapshot are discarded, since neither can shrink. Modules with mutable
+// globals of reference type are not pooled, since snapshots only capture
+// numeric globals.
+
+struct InstancePoolImpl : InstancePool {
+  StoreImpl* store;
+  own<Snapshot> snapshot;
+  ownvec<Extern> imports;
+  vec<Extern*> import_ptrs;
+  size_t capacity;
+  std::vector<own<Instance>> instances;
+  size_t hits = 0;
+  size_t misses = 0;
+  size_t resets = 0;
+  uint64_t reset_ns = 0;
+
+  InstancePoolImpl() :
+    imports(ownvec<Extern>::make()), import_ptrs(vec<Extern*>::make()) {
+    stats.make(Stats::INSTANCEPOOL, this);
+  }
+
+  ~InstancePoolImpl() {
+    stats.free(Stats::INSTANCEPOOL, this);
+  }
+};
+
+template<> struct implement<InstancePool> { using type = InstancePoolImpl; };
+
+
+void InstancePool::destroy() {
+  delete impl(this);
+}
+
+auto InstancePool::make(
+  Store* store_abs, const Module* module, const vec<Extern*>& imports,
+  size_t capacity, own<Trap>* trap
+) -> own<InstancePool> {
+  auto store = impl(store_abs);
+  if (trap) *trap = nullptr;
+  {
+    v8::HandleScope handle_scope(store->isolate());
+    auto data = module_data(store, impl(module)->v8_object());
+    if (!data || bin::mutable_ref_globals(data->index)) {
+      return own<InstancePool>();
+    }
+  }
+  auto instance = Instance::make(store, module, imports, trap);
+  if (!instance) return own<InstancePool>();
+  auto pool = own<InstancePoolImpl>(new(std::nothrow) InstancePoolImpl());
+  if (!pool) return own<InstancePool>();
+  pool->store = store;
+  pool->capacity = capacity;
+  pool->snapshot = instance->snapshot();
+  if (!pool->snapshot) return own<InstancePool>();
+  pool->imports = ownvec<Extern>::make_uninitialized(imports.size());
+  pool->import_ptrs = vec<Extern*>::make_uninitialized(imports.size());
+  for (size_t i = 0; i < imports.size(); ++i) {
+    pool->imports[i] = imports[i]->copy();
+    pool->import_ptrs[i] = pool->imports[i].get();
+  }
+  if (capacity > 0) pool->instances.push_back(std::move(instance));
+  return own<InstancePool>(pool.release());
+}
+
+auto InstancePool::acquire(own<Trap>* trap) -> own<Instance> {
+  auto pool = impl(this);
+  if (trap) *trap = nullptr;
+  if (!pool->instances.empty()) {
+    ++pool->hits;
+    auto instance = std::move(pool->instances.back());
+    pool->instances.pop_back();
+    return instance;
+  }
+  ++pool->misses;
+  return Instance::make_from_snapshot(
+    pool->store, pool->snapshot.get(), pool->import_ptrs, trap);
+}
+
+void InstancePool::release(own<Instance>&& instance) {
+  auto pool = impl(this);
+  auto owned = std::move(instance);
+  if (!owned || pool->instances.size() >= pool->capacity) return;
+
+  auto isolate = pool->store->isolate();
+  v8::HandleScope handle_scope(isolate);
+  auto snapshot = impl(pool->snapshot.get());
+  auto instance_obj = impl(owned.get())->v8_object();
+  auto module_obj = wasm_v8::instance_module(instance_obj);
+  if (!module_obj->StrictEquals(snapshot->module.Get(isolate)) &&
+      !module_obj->StrictEquals(snapshot->startless.Get(isolate))) {
+    return;
+  }
+  if (snapshot->has_memory) {
+    auto memory = wasm_v8::instance_memory(instance_obj).ToLocalChecked();
+    if (wasm_v8::memory_data_size(memory) != snapshot->memory_size) return;
+  }
+  auto first = bin::count(snapshot->data->info, ExternKind::TABLE);
+  for (size_t t = 0; t < snapshot->tables.size(); ++t) {
+    auto table = wasm_v8::instance_table(instance_obj, first + t);
+    if (wasm_v8::table_size(table) != snapshot->tables[t].size()) return;
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  auto ok = restore(snapshot, instance_obj);
+  auto end = std::chrono::steady_clock::now();
+  pool->reset_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(
+    end - start).count();
+  ++pool->resets;
+  if (ok) pool->instances.push_back(std::move(owned));
+}
+
+auto InstancePool::size() const -> size_t {
+  return impl(this)->instances.size();
+}
+
+auto InstancePool::hits() const -> size_t {
+  return impl(this)->hits;
+}
+
+auto InstancePool::misses() const -> size_t {
+  return impl(this)->misses;
+}
+
+auto InstancePool::resets() const -> size_t {
+  return impl(this)->resets;
+}
+
+auto InstancePool::reset_nanoseconds() const -> uint64_t {
+  return impl(this)->reset_ns;
+}
+
+
+// Linkers
+
+// Imports are resolved and type-checked when defined. The import object is
+// built on the first instantiation after a definition and reused by all
+// instantiations that follow.
+
+struct LinkerImpl : Linker {
+  StoreImpl* store;
+  v8::Persistent<v8::Object> module;
+  ModuleData* data;  // owned by the module object
+  std::vector<own<Extern>> imports;  // in import order, null if undefined
+  std::vector<const Extern*> import_ptrs;
+  v8::Persistent<v8::Object> imports_obj;  // empty if outdated
+
+  LinkerImpl() {
+    stats.make(Stats::LINKER, this);
+  }
+
+  ~LinkerImpl() {
+    module.Reset();
+    imports_obj.Reset();
+    stats.free(Stats::LINKER, this);
+  }
+};
+
+template<> struct implement<Linker> { using type = LinkerImpl; };
+
+
+void Linker::destroy() {
+  delete impl(this);
+}
+
+auto Linker::make(Store* store_abs, const Module* module_abs) -> own<Linker> {
+  auto store = impl(store_abs);
+  auto module = impl(module_abs);
+  auto isolate = store->isolate();
+  v8::HandleScope handle_scope(isolate);
+
+  auto data = module_data(store, module->v8_object());
+  if (!data) return own<Linker>();
+  auto linker = own<LinkerImpl>(new(std::nothrow) LinkerImpl());
+  if (!linker) return own<Linker>();
+  linker->store = store;
+  linker->module.Reset(isolate, module->v8_object());
+  linker->data = data;
+  linker->imports.resize(data->info.imports.size());
+  linker->import_ptrs.resize(data->info.imports.size(), nullptr);
+  return own<Linker>(linker.release());
+}
+
+auto Linker::define(
+  const Name& module, const Name& name, const Extern* external
+) -> bool {
+  auto linker = impl(this);
+  v8::HandleScope handle_scope(linker->store->isolate());
+  auto& info = linker->data->info;
+  auto same = [](const bin::Span& span, const Name& name) {
+    return span.size == name.size() &&
+      (span.size == 0 || std::memcmp(span.data, name.get(), span.size) == 0);
+  };
+
+  bool found = false;
+  own<ExternType> type;
+  for (size_t i = 0; i < info.imports.size(); ++i) {
+    auto& import = info.imports[i];
+    if (!same(import.module, module) || !same(import.name, name)) continue;
+    if (!type) type = external->type();
+    if (!bin::matches(info, import.type, type.get())) return false;
+    found = true;
+  }
+  if (!found) return false;
+
+  for (size_t i = 0; i < info.imports.size(); ++i) {
+    auto& import = info.imports[i];
+    if (!same(import.module, module) || !same(import.name, name)) continue;
+    linker->imports[i] = external->copy();
+    linker->import_ptrs[i] = linker->imports[i].get();
+  }
+  linker->imports_obj.Reset();
+  return true;
+}
+
+auto Linker::instantiate(own<Trap>* trap) -> own<Instance> {
+  auto linker = impl(this);
+  auto store = linker->store;
+  auto isolate = store->isolate();
+  v8::HandleScope handle_scope(isolate);
+
+  if (trap) *trap = nullptr;
+  if (linker->imports_obj.IsEmpty()) {
+    auto& info = linker->data->info;
+    for (size_t i = 0; i < info.imports.size(); ++i) {
+      if (linker->import_ptrs[i] == nullptr) {
+        if (trap) {
+          auto& import = info.imports[i];
+          auto message = std::string("unresolved import ") +
+            std::string(import.module.data, import.module.size) + "." +
+            std::string(import.name.data, import.name.size);
+          *trap = Trap::make(store, Name::make_nt(message));
+        }
+        return nullptr;
+      }
+    }
+    auto maybe_imports_obj =
+      imports_object(store, linker->module.Get(isolate), linker->data,
+        linker->import_ptrs.data());
+    if (maybe_imports_obj.IsEmpty()) return own<Instance>();
+    linker->imports_obj.Reset(isolate, maybe_imports_obj.ToLocalChecked());
+  }
+
+  return wasm::instantiate(store, linker->module.Get(isolate),
+    linker->imports_obj.Get(isolate), trap);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 }  // namespace wasm